@@ -3,16 +3,28 @@
 #include "hardware/LimeSDRDevice.hpp"
 #include "types/RxMissionConfig.hpp"
 #include "types/TxMissionConfig.hpp"
+#include "types/IndexQueryConfig.hpp"
+#include "types/CaptureConversionConfig.hpp"
+#include "tools/CaptureConverter.hpp"
+#include "tools/IndexQuery.hpp"
+#include "tools/Benchmark.hpp"
+#include "tracing/Tracer.hpp"
 #include "Application.hpp"
 
-inline const char* StartRxMissionSlot   = "startRxMission";
-inline const char* StartTxMissionSlot   = "startTxMission";
+inline const char* StartRxMissionSlot       = "startRxMission";
+inline const char* StartTxMissionSlot       = "startTxMission";
+inline const char* RunBenchmarkSlot         = "runBenchmark";
+inline const char* RunIndexQuerySlot        = "runIndexQuery";
+inline const char* RunCaptureConversionSlot = "runCaptureConversion";
 
 Application::Application(int& argc, char** argv, int flags)
     : QCoreApplication(argc, argv, flags)
 {
     qRegisterMetaType<RxMissionConfig>("RxMissionConfig");
     qRegisterMetaType<TxMissionConfig>("TxMissionConfig");
+    qRegisterMetaType<IndexQueryConfig>("IndexQueryConfig");
+    qRegisterMetaType<CaptureConversionConfig>("CaptureConversionConfig");
+    qRegisterMetaType<SampleBlockPtr>("SampleBlockPtr");
 
     QMetaObject::invokeMethod(this, &Application::onEventLoopInitialization, Qt::QueuedConnection);
 }
@@ -24,6 +36,9 @@ Application::~Application()
         if (device) delete device;
     }
     mDevices.clear();
+
+    // Device destructors join the mission threads, their spans are complete
+    Tracer::instance().stop();
 }
 
 void Application::onEventLoopInitialization()
@@ -34,6 +49,9 @@ void Application::onEventLoopInitialization()
         return;
     }
 
+    if (mOfflineUseCase) return;
+
+    TRACE_SCOPE("Application::devicesInitialization");
     mDevices = LimeSDRDevice::availableDevicesList();
 
     if (mDevices.isEmpty())
@@ -46,6 +64,8 @@ void Application::onEventLoopInitialization()
 
 void Application::startRxMission(const RxMissionConfig& config)
 {
+    TRACE_SCOPE("Application::startRxMission");
+
     if (config.deviceNumber >= mDevices.count())
     {
         qWarning("[Application] No such device number!");
@@ -74,6 +94,8 @@ void Application::startRxMission(const RxMissionConfig& config)
 
 void Application::startTxMission(const TxMissionConfig& config)
 {
+    TRACE_SCOPE("Application::startTxMission");
+
     if (config.deviceNumber >= mDevices.count())
     {
         qWarning("[Application] No such device number!");
@@ -100,25 +122,138 @@ void Application::startTxMission(const TxMissionConfig& config)
     }
 }
 
+void Application::runBenchmark(const QString& name)
+{
+    exit(RunBenchmark(name) ? NormalExit : CmdArgumentsError);
+}
+
+void Application::runIndexQuery(const IndexQueryConfig& config)
+{
+    exit(RunIndexQuery(config) ? NormalExit : CmdArgumentsError);
+}
+
+void Application::runCaptureConversion(const CaptureConversionConfig& config)
+{
+    exit(RunCaptureConversion(config) ? NormalExit : ConversionError);
+}
+
 bool Application::processCommandLineArguments()
 {
     QCommandLineParser argsParser;
     QCommandLineOption useAsServer("s", "Work as server in client-server use-case.");
     QCommandLineOption rxMission("rx", "RX mission exec.");
     QCommandLineOption txMission("tx", "TX mission exec.");
+    QCommandLineOption sharedMemory("shm", "Publish RX blocks into POSIX shared memory ring.", "name");
+    QCommandLineOption sharedMemorySlots("shm-slots", "Shared memory ring size in blocks.", "count", "64");
+    QCommandLineOption iqCorrection("iq-correction", "Correct RX DC offset and IQ imbalance before recording.");
+    QCommandLineOption channels("channels", "Split RX capture into N channel files (power of two).", "count", "0");
+    QCommandLineOption ring("ring", "Keep only last N seconds of RX in a ring, dump it on SIGUSR1.", "seconds", "0");
+    QCommandLineOption preamble("preamble", "Detect preamble (I16 IQ file) in RX by matched filter.", "file");
+    QCommandLineOption preambleThreshold("preamble-threshold", "Preamble normalized correlation threshold, 0..1.", "value", "0.5");
+    QCommandLineOption agc("agc", "Adjust RX gain between blocks to keep mean power at target.", "dBFS");
+    QCommandLineOption preambleWindow("preamble-window", "Save N samples starting at every detected preamble.", "samples", "0");
+    QCommandLineOption query("query", "Search RX capture folder by its index.", "folder");
+    QCommandLineOption queryFrom("from", "Query: range start, seconds from recording start.", "seconds", "0");
+    QCommandLineOption queryTo("to", "Query: range end, seconds from recording start.", "seconds", "-1");
+    QCommandLineOption queryAbove("above", "Query: only blocks with peak power above threshold.", "dBFS");
+    QCommandLineOption queryExtract("extract", "Query: write found ranges into contiguous file.", "file");
+    QCommandLineOption convert("convert", "Merge RX capture folder (or folder of captures) into single files.", "folder");
+    QCommandLineOption convertFormat("format", "Convert: output sample format, i16, f32 or i8.", "format", "i16");
+    QCommandLineOption convertCompress("compress", "Convert: compress every block with zlib.");
+    QCommandLineOption convertOutput("output", "Convert: output folder.", "folder", "CONVERTED");
+    QCommandLineOption convertRate("rate", "Convert: sample rate of captures without index.", "Hz", "0");
+    QCommandLineOption convertFrequency("frequency", "Convert: frequency of captures without index.", "Hz", "0");
+    QCommandLineOption txFormat("tx-format", "TX file sample format: i16, f32 or i8.", "format", "i16");
+    QCommandLineOption txRate("tx-rate", "TX file sample rate, resampled to the mission rate.", "Hz", "0");
+    QCommandLineOption txDigitalGain("tx-digital-gain", "Scale TX samples before sending.", "dB", "0");
+    QCommandLineOption trace("trace", "Save startup and mission timeline as Chrome trace JSON.", "file");
+    QCommandLineOption benchmark("benchmark", QString("Run offline benchmark: ") + BenchmarkNames() + ".", "name");
 
     argsParser.addHelpOption();
     argsParser.addOption(useAsServer);
     argsParser.addOption(rxMission);
     argsParser.addOption(txMission);
+    argsParser.addOption(sharedMemory);
+    argsParser.addOption(sharedMemorySlots);
+    argsParser.addOption(iqCorrection);
+    argsParser.addOption(channels);
+    argsParser.addOption(ring);
+    argsParser.addOption(preamble);
+    argsParser.addOption(preambleThreshold);
+    argsParser.addOption(preambleWindow);
+    argsParser.addOption(agc);
+    argsParser.addOption(benchmark);
+    argsParser.addOption(query);
+    argsParser.addOption(queryFrom);
+    argsParser.addOption(queryTo);
+    argsParser.addOption(queryAbove);
+    argsParser.addOption(queryExtract);
+    argsParser.addOption(convert);
+    argsParser.addOption(convertFormat);
+    argsParser.addOption(convertCompress);
+    argsParser.addOption(convertOutput);
+    argsParser.addOption(convertRate);
+    argsParser.addOption(convertFrequency);
+    argsParser.addOption(txFormat);
+    argsParser.addOption(txRate);
+    argsParser.addOption(txDigitalGain);
+    argsParser.addOption(trace);
     argsParser.process(arguments());
 
+    if (argsParser.isSet(trace))
+    {
+        Tracer::instance().start(argsParser.value(trace));
+        Tracer::instance().setThreadName("main");
+    }
+
     if (argsParser.isSet(useAsServer))
     {
         qInfo("This functionary not supported yet!");
         mConsoleUseCase = false;
         return false;
     }
+    else if (argsParser.isSet(benchmark))
+    {
+        mOfflineUseCase = true;
+        QMetaObject::invokeMethod(this, RunBenchmarkSlot, Qt::QueuedConnection,
+                                  Q_ARG(QString, argsParser.value(benchmark)));
+        return true;
+    }
+    else if (argsParser.isSet(query))
+    {
+        IndexQueryConfig config;
+        config.directory = argsParser.value(query);
+        config.fromSeconds = argsParser.value(queryFrom).toDouble();
+        config.toSeconds = argsParser.value(queryTo).toDouble();
+        config.energeticOnly = argsParser.isSet(queryAbove);
+        config.thresholdDbfs = argsParser.value(queryAbove).toDouble();
+        config.extractPath = argsParser.value(queryExtract);
+
+        mOfflineUseCase = true;
+        QMetaObject::invokeMethod(this, RunIndexQuerySlot, Qt::QueuedConnection,
+                                  Q_ARG(IndexQueryConfig, config));
+        return true;
+    }
+    else if (argsParser.isSet(convert))
+    {
+        CaptureConversionConfig config;
+        config.source = argsParser.value(convert);
+        config.outputDirectory = argsParser.value(convertOutput);
+        config.compress = argsParser.isSet(convertCompress);
+        config.sampleRate = argsParser.value(convertRate).toULongLong();
+        config.frequency = argsParser.value(convertFrequency).toULongLong();
+
+        if (not ParseSampleFormat(argsParser.value(convertFormat), config.format))
+        {
+            qWarning("Invalid convert format '%s'!", qPrintable(argsParser.value(convertFormat)));
+            return false;
+        }
+
+        mOfflineUseCase = true;
+        QMetaObject::invokeMethod(this, RunCaptureConversionSlot, Qt::QueuedConnection,
+                                  Q_ARG(CaptureConversionConfig, config));
+        return true;
+    }
     else if (argsParser.isSet(rxMission))
     {
         const auto args = argsParser.positionalArguments();
@@ -130,6 +265,17 @@ bool Application::processCommandLineArguments()
         }
 
         RxMissionConfig config;
+        config.sharedMemoryName = argsParser.value(sharedMemory);
+        config.sharedMemorySlots = argsParser.value(sharedMemorySlots).toUInt();
+        config.iqCorrection = argsParser.isSet(iqCorrection);
+        config.channelsCount = argsParser.value(channels).toUInt();
+        config.ringSeconds = argsParser.value(ring).toDouble();
+        config.preambleFileName = argsParser.value(preamble);
+        config.preambleThreshold = argsParser.value(preambleThreshold).toDouble();
+        config.preambleWindow = argsParser.value(preambleWindow).toUInt();
+        config.agc = argsParser.isSet(agc);
+        config.agcTargetDbfs = argsParser.value(agc).toDouble();
+
         if (not config.parse(args))
         {
             qWarning("Invalid rx mission config!");
@@ -151,6 +297,15 @@ bool Application::processCommandLineArguments()
         }
 
         TxMissionConfig config;
+        config.fileSampleRate = argsParser.value(txRate).toULongLong();
+        config.digitalGainDb = argsParser.value(txDigitalGain).toDouble();
+
+        if (not ParseSampleFormat(argsParser.value(txFormat), config.fileFormat))
+        {
+            qWarning("Invalid tx file format '%s'!", qPrintable(argsParser.value(txFormat)));
+            return false;
+        }
+
         if (not config.parse(args))
         {
             qWarning("Invalid tx mission config!");
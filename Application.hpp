@@ -4,6 +4,8 @@
 class LimeSDRDevice;
 struct RxMissionConfig;
 struct TxMissionConfig;
+struct IndexQueryConfig;
+struct CaptureConversionConfig;
 
 class Application : public QCoreApplication
 {
@@ -14,7 +16,8 @@ private:
         NormalExit = 0,
         CmdArgumentsError,
         DevicesInitError,
-        MissionError
+        MissionError,
+        ConversionError
     };
 
 public:
@@ -25,6 +28,9 @@ private slots:
     void onEventLoopInitialization();
     void startRxMission(const RxMissionConfig& config);
     void startTxMission(const TxMissionConfig& config);
+    void runBenchmark(const QString& name);
+    void runIndexQuery(const IndexQueryConfig& config);
+    void runCaptureConversion(const CaptureConversionConfig& config);
 
 private:
     bool processCommandLineArguments();
@@ -32,5 +38,6 @@ private:
 private:
     QList<LimeSDRDevice*> mDevices;
     bool mConsoleUseCase = true;
+    bool mOfflineUseCase = false;
 };
 
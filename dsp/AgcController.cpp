@@ -0,0 +1,66 @@
+#include <cmath>
+
+#include "BlockStatistics.hpp"
+#include "AgcController.hpp"
+
+inline const double ClippedFractionLimit = 1e-4;
+inline const double ClipBackoffDb = 6;
+inline const double HysteresisDb = 3;
+inline const double MaxStepDb = 6;
+inline const double PeakHeadroomDb = 1;
+// Not less than the RX FIFO depth, blocks in the FIFO predate the change
+inline const int SettleBlocks = 2;
+
+AgcController::AgcController(double targetDbfs, unsigned initialGain,
+                             unsigned minimumGain, unsigned maximumGain)
+    : mTargetDbfs(targetDbfs)
+    , mGain(qBound(minimumGain, initialGain, maximumGain))
+    , mMinimumGain(minimumGain)
+    , mMaximumGain(maximumGain)
+{
+
+}
+
+bool AgcController::update(const BlockStatistics& statistics, unsigned& gain)
+{
+    if (mSettleBlocks > 0)
+    {
+        --mSettleBlocks;
+        return false;
+    }
+
+    double stepDb = 0;
+    if (statistics.clippedFraction() > ClippedFractionLimit)
+    {
+        stepDb = -ClipBackoffDb;
+    }
+    else
+    {
+        const double errorDb = mTargetDbfs - statistics.meanPowerDbfs();
+        if (std::abs(errorDb) < HysteresisDb) return false;
+
+        stepDb = qBound(-MaxStepDb, errorDb, MaxStepDb);
+
+        // Raising is limited by the peak, not only by the mean
+        const double headroomDb = -PeakHeadroomDb - statistics.peakPowerDbfs();
+        if (stepDb > 0) stepDb = qMin(stepDb, headroomDb);
+        if (stepDb > -1 and stepDb < 1) return false;
+    }
+
+    const int target = qBound<int>(mMinimumGain, std::lround(mGain + stepDb), mMaximumGain);
+    if (unsigned(target) == mGain) return false;
+
+    gain = target;
+    return true;
+}
+
+void AgcController::applied(unsigned gain)
+{
+    mGain = gain;
+    mSettleBlocks = SettleBlocks;
+}
+
+unsigned AgcController::gain() const
+{
+    return mGain;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QtGlobal>
+
+struct BlockStatistics;
+
+// Block rate AGC for the RX front-end gain. Clipping drops the gain at
+// once, otherwise the mean power is pulled towards the target in limited
+// steps, keeping the peak under full scale. After a change a few blocks are
+// skipped: they were captured before the new gain took effect.
+class AgcController
+{
+public:
+    AgcController(double targetDbfs, unsigned initialGain,
+                  unsigned minimumGain = 0, unsigned maximumGain = 73);
+
+    // Returns true if the gain should be changed to gain
+    bool update(const BlockStatistics& statistics, unsigned& gain);
+
+    // Called after the gain was applied to the device
+    void applied(unsigned gain);
+
+    unsigned gain() const;
+
+private:
+    double mTargetDbfs;
+    unsigned mGain;
+    unsigned mMinimumGain;
+    unsigned mMaximumGain;
+    int mSettleBlocks = 0;
+};
@@ -0,0 +1,91 @@
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "BlockStatistics.hpp"
+
+double BlockStatistics::meanPower() const
+{
+    return count ? sumPower / count : 0;
+}
+
+double BlockStatistics::meanPowerDbfs() const
+{
+    return PowerToDbfs(meanPower());
+}
+
+double BlockStatistics::peakPowerDbfs() const
+{
+    return PowerToDbfs(peakPower);
+}
+
+double BlockStatistics::clippedFraction() const
+{
+    return count ? double(clippedSamples) / count : 0;
+}
+
+double PowerToDbfs(double power)
+{
+    return (power > 0) ? 10 * std::log10(power / FullScalePower) : -300.0;
+}
+
+void AccumulateBlockStatistics(const qint16* samples, size_t count, BlockStatistics& statistics)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i minimum = _mm_set1_epi16(-32767);
+    const __m128i clipHigh = _mm_set1_epi16(ClipLevel - 1);
+    const __m128i clipLow = _mm_set1_epi16(-ClipLevel + 1);
+    __m128i clipped = _mm_setzero_si128();
+    __m128d sumLow = _mm_setzero_pd();
+    __m128d sumHigh = _mm_setzero_pd();
+    __m128i peak = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i * 2));
+        x = _mm_max_epi16(x, minimum);
+
+        const __m128i power = _mm_madd_epi16(x, x);
+        sumLow = _mm_add_pd(sumLow, _mm_cvtepi32_pd(power));
+        sumHigh = _mm_add_pd(sumHigh, _mm_cvtepi32_pd(_mm_shuffle_epi32(power, _MM_SHUFFLE(1, 0, 3, 2))));
+
+        // No 32-bit max in SSE2, select by compare
+        const __m128i greater = _mm_cmpgt_epi32(power, peak);
+        peak = _mm_or_si128(_mm_and_si128(greater, power), _mm_andnot_si128(greater, peak));
+
+        // Sign bit of the 32-bit lane is set if I or Q of the sample is clipped
+        const __m128i clip = _mm_or_si128(_mm_cmpgt_epi16(x, clipHigh), _mm_cmplt_epi16(x, clipLow));
+        clipped = _mm_add_epi32(clipped, _mm_srli_epi32(_mm_or_si128(clip, _mm_slli_epi32(clip, 16)), 31));
+    }
+
+    double sums[2];
+    _mm_storeu_pd(sums, _mm_add_pd(sumLow, sumHigh));
+    statistics.sumPower += sums[0] + sums[1];
+
+    quint32 peaks[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(peaks), peak);
+    for (auto value : peaks) statistics.peakPower = qMax(statistics.peakPower, value);
+
+    quint32 clips[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(clips), clipped);
+    statistics.clippedSamples += clips[0] + clips[1] + clips[2] + clips[3];
+#endif
+
+    for (; i < count; ++i)
+    {
+        const qint32 sampleI = qMax<qint16>(samples[i * 2], -32767);
+        const qint32 sampleQ = qMax<qint16>(samples[i * 2 + 1], -32767);
+        const quint32 power = sampleI * sampleI + sampleQ * sampleQ;
+
+        statistics.sumPower += power;
+        statistics.peakPower = qMax(statistics.peakPower, power);
+
+        if (qAbs(sampleI) >= ClipLevel or qAbs(sampleQ) >= ClipLevel) ++statistics.clippedSamples;
+    }
+
+    statistics.count += count;
+}
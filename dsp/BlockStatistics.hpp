@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+inline const double FullScalePower = 32767.0 * 32767.0;
+
+// LMS_FMT_I16 is the 12-bit ADC scaled to 16 bits: its top is 32752.
+// A sample with I or Q at or above this level (about -0.2 dBFS) is clipped.
+inline const qint16 ClipLevel = 32000;
+
+// Power statistics of interleaved I16 IQ samples, power is I^2 + Q^2.
+// -32768 is counted as -32767 so one sample power fits into 31 bits.
+struct BlockStatistics
+{
+    double sumPower = 0;
+    quint32 peakPower = 0;
+    quint32 clippedSamples = 0;
+    size_t count = 0;
+
+    double meanPower() const;
+
+    // Relative to a full scale sinusoid (32767^2)
+    double meanPowerDbfs() const;
+    double peakPowerDbfs() const;
+    double clippedFraction() const;
+};
+
+void AccumulateBlockStatistics(const qint16* samples, size_t count, BlockStatistics& statistics);
+
+double PowerToDbfs(double power);
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <utility>
+
+#include "Fft.hpp"
+
+Fft::Fft(size_t size)
+    : mSize(size)
+    , mTwiddles(size / 2)
+    , mReversed(size)
+{
+    for (size_t i = 0; i < size / 2; ++i)
+    {
+        const double angle = -2 * M_PI * i / size;
+        mTwiddles[i] = std::complex<float>(std::cos(angle), std::sin(angle));
+    }
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < size) ++bits;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < bits; ++bit)
+        {
+            if (i & (size_t(1) << bit)) reversed |= size_t(1) << (bits - 1 - bit);
+        }
+        mReversed[i] = reversed;
+    }
+}
+
+size_t Fft::size() const
+{
+    return mSize;
+}
+
+void Fft::forward(std::complex<float>* data) const
+{
+    transform(data, false);
+}
+
+void Fft::inverse(std::complex<float>* data) const
+{
+    transform(data, true);
+}
+
+bool Fft::isPowerOfTwo(size_t value)
+{
+    return value not_eq 0 and (value & (value - 1)) == 0;
+}
+
+void Fft::transform(std::complex<float>* data, bool inverse) const
+{
+    for (size_t i = 0; i < mSize; ++i)
+    {
+        if (i < mReversed[i]) std::swap(data[i], data[mReversed[i]]);
+    }
+
+    for (size_t length = 2; length <= mSize; length <<= 1)
+    {
+        const size_t half = length / 2;
+        const size_t step = mSize / length;
+
+        for (size_t begin = 0; begin < mSize; begin += length)
+        {
+            for (size_t i = 0; i < half; ++i)
+            {
+                const auto twiddle = mTwiddles[i * step];
+                const float twiddleImag = inverse ? -twiddle.imag() : twiddle.imag();
+                const auto value = data[begin + i + half];
+
+                // Plain multiply: std::complex operator* checks for NaN/inf
+                const std::complex<float> odd(value.real() * twiddle.real() - value.imag() * twiddleImag,
+                                              value.real() * twiddleImag + value.imag() * twiddle.real());
+
+                data[begin + i + half] = data[begin + i] - odd;
+                data[begin + i] += odd;
+            }
+        }
+    }
+}
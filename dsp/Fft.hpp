@@ -0,0 +1,27 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+// In-place radix-2 complex FFT, size must be a power of two.
+// Neither direction is normalized.
+class Fft
+{
+public:
+    explicit Fft(size_t size);
+
+    size_t size() const;
+
+    void forward(std::complex<float>* data) const;
+    void inverse(std::complex<float>* data) const;
+
+    static bool isPowerOfTwo(size_t value);
+
+private:
+    void transform(std::complex<float>* data, bool inverse) const;
+
+private:
+    size_t mSize;
+    std::vector<std::complex<float>> mTwiddles;
+    std::vector<size_t> mReversed;
+};
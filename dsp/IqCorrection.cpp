@@ -0,0 +1,120 @@
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "IqCorrection.hpp"
+
+inline qint16 Saturate(float value)
+{
+    return static_cast<qint16>(qBound(-32768.0f, std::nearbyint(value), 32767.0f));
+}
+
+void AccumulateIqMoments(const qint16* samples, size_t count, IqMoments& moments)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i maskI = _mm_set_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+    const __m128i maskQ = _mm_set_epi16(-1, 0, -1, 0, -1, 0, -1, 0);
+    const __m128i onesI = _mm_set_epi16(0, 1, 0, 1, 0, 1, 0, 1);
+    const __m128i onesQ = _mm_set_epi16(1, 0, 1, 0, 1, 0, 1, 0);
+
+    __m128d sumI = _mm_setzero_pd();
+    __m128d sumQ = _mm_setzero_pd();
+    __m128d sumII = _mm_setzero_pd();
+    __m128d sumQQ = _mm_setzero_pd();
+    __m128d sumIQ = _mm_setzero_pd();
+
+    // Every madd lane holds one sample, so 32-bit lanes can not overflow
+    // before they are widened to doubles
+    const auto accumulate = [](__m128d& sum, __m128i lanes)
+    {
+        sum = _mm_add_pd(sum, _mm_cvtepi32_pd(lanes));
+        sum = _mm_add_pd(sum, _mm_cvtepi32_pd(_mm_shuffle_epi32(lanes, _MM_SHUFFLE(1, 0, 3, 2))));
+    };
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i * 2));
+        const __m128i onlyI = _mm_and_si128(x, maskI);
+        const __m128i onlyQ = _mm_and_si128(x, maskQ);
+        const __m128i swapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)),
+                                                    _MM_SHUFFLE(2, 3, 0, 1));
+
+        accumulate(sumI, _mm_madd_epi16(x, onesI));
+        accumulate(sumQ, _mm_madd_epi16(x, onesQ));
+        accumulate(sumII, _mm_madd_epi16(onlyI, onlyI));
+        accumulate(sumQQ, _mm_madd_epi16(onlyQ, onlyQ));
+        accumulate(sumIQ, _mm_madd_epi16(onlyI, swapped));
+    }
+
+    const auto horizontal = [](__m128d sum)
+    {
+        double lanes[2];
+        _mm_storeu_pd(lanes, sum);
+        return lanes[0] + lanes[1];
+    };
+
+    moments.sumI += horizontal(sumI);
+    moments.sumQ += horizontal(sumQ);
+    moments.sumII += horizontal(sumII);
+    moments.sumQQ += horizontal(sumQQ);
+    moments.sumIQ += horizontal(sumIQ);
+#endif
+
+    for (; i < count; ++i)
+    {
+        const double sampleI = samples[i * 2];
+        const double sampleQ = samples[i * 2 + 1];
+
+        moments.sumI += sampleI;
+        moments.sumQ += sampleQ;
+        moments.sumII += sampleI * sampleI;
+        moments.sumQQ += sampleQ * sampleQ;
+        moments.sumIQ += sampleI * sampleQ;
+    }
+
+    moments.count += count;
+}
+
+void ApplyIqCorrection(const qint16* input, qint16* output, size_t count,
+                       const IqCorrectionParameters& parameters)
+{
+    const float crossScale = -parameters.scale * parameters.cross;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128 dc = _mm_set_ps(parameters.dcQ, parameters.dcI, parameters.dcQ, parameters.dcI);
+    const __m128 direct = _mm_set_ps(parameters.scale, 1.0f, parameters.scale, 1.0f);
+    const __m128 leak = _mm_set_ps(crossScale, 0.0f, crossScale, 0.0f);
+
+    const auto correct = [&](__m128i lanes)
+    {
+        const __m128 centered = _mm_sub_ps(_mm_cvtepi32_ps(lanes), dc);
+        const __m128 swapped = _mm_shuffle_ps(centered, centered, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(centered, direct),
+                                          _mm_mul_ps(swapped, leak)));
+    };
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 2));
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 2),
+                         _mm_packs_epi32(correct(low), correct(high)));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        const float sampleI = input[i * 2] - parameters.dcI;
+        const float sampleQ = input[i * 2 + 1] - parameters.dcQ;
+
+        output[i * 2] = Saturate(sampleI);
+        output[i * 2 + 1] = Saturate(parameters.scale * sampleQ + crossScale * sampleI);
+    }
+}
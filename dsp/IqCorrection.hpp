@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+// Kernels work on interleaved I16 IQ samples: I0 Q0 I1 Q1 ...
+
+struct IqMoments
+{
+    double sumI = 0;
+    double sumQ = 0;
+    double sumII = 0;
+    double sumQQ = 0;
+    double sumIQ = 0;
+    size_t count = 0;
+};
+
+struct IqCorrectionParameters
+{
+    float dcI = 0;
+    float dcQ = 0;
+    float cross = 0;    // part of I leaked into Q by the phase error
+    float scale = 1;    // Q gain correction
+};
+
+void AccumulateIqMoments(const qint16* samples, size_t count, IqMoments& moments);
+
+// I' = I - dcI
+// Q' = scale * ((Q - dcQ) - cross * (I - dcI))
+void ApplyIqCorrection(const qint16* input, qint16* output, size_t count,
+                       const IqCorrectionParameters& parameters);
@@ -0,0 +1,148 @@
+#include <cmath>
+#include <algorithm>
+
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "SampleConversion.hpp"
+#include "OverlapSaveCorrelator.hpp"
+
+inline const size_t MinFftSize = 1024;
+inline const size_t SegmentsPerTask = 4;
+
+size_t OverlapSaveCorrelator::defaultFftSize(size_t referenceLength)
+{
+    // Keeps at least 3/4 of every segment as valid output
+    size_t size = MinFftSize;
+    while (size < referenceLength * 4) size *= 2;
+    return size;
+}
+
+OverlapSaveCorrelator::OverlapSaveCorrelator(const std::vector<std::complex<float>>& reference,
+                                             float threshold, size_t fftSize)
+    : mLength(std::max<size_t>(reference.size(), 1))
+    , mFft(fftSize ? fftSize : defaultFftSize(mLength))
+    , mStep(mFft.size() - mLength + 1)
+    , mThreshold(threshold)
+{
+    const size_t size = mFft.size();
+    mReferenceSpectrum.assign(size, 0);
+    std::copy(reference.begin(), reference.end(), mReferenceSpectrum.begin());
+
+    for (const auto& sample : reference) mReferenceEnergy += std::norm(sample);
+
+    mFft.forward(mReferenceSpectrum.data());
+    for (auto& bin : mReferenceSpectrum) bin = std::conj(bin) / float(size);
+}
+
+size_t OverlapSaveCorrelator::referenceLength() const
+{
+    return mLength;
+}
+
+size_t OverlapSaveCorrelator::fftSize() const
+{
+    return mFft.size();
+}
+
+size_t OverlapSaveCorrelator::process(const qint16* samples, size_t count, std::vector<Detection>& detections,
+                                      WorkStealingThreadPool* pool)
+{
+    const size_t size = mFft.size();
+    const size_t offset = mInput.size();
+
+    mInput.resize(offset + count);
+    ConvertToFloat(reinterpret_cast<const char*>(samples), SampleFormat::I16, count,
+                   reinterpret_cast<float*>(mInput.data() + offset));
+
+    const size_t segments = (mInput.size() >= size) ? (mInput.size() - size) / mStep + 1 : 0;
+    if (segments == 0) return 0;
+
+    const size_t outputs = segments * mStep;
+    mCorrelation.resize(outputs);
+    mEnergy.resize(outputs);
+
+    const auto work = [&](size_t begin, size_t end)
+    {
+        std::vector<std::complex<float>> buffer(size);
+        for (size_t segment = begin; segment < end; ++segment) correlateSegment(segment, buffer.data());
+    };
+
+    if (pool) pool->parallelFor(segments, SegmentsPerTask, work);
+    else work(0, segments);
+
+    pickPeaks(outputs, detections);
+
+    mInput.erase(mInput.begin(), mInput.begin() + outputs);
+    mInputPosition += outputs;
+    return outputs;
+}
+
+void OverlapSaveCorrelator::finish(std::vector<Detection>& detections)
+{
+    if (mInPeak) detections.push_back(mPeak);
+    mInPeak = false;
+}
+
+quint64 OverlapSaveCorrelator::pendingFrom() const
+{
+    return mInPeak ? mPeak.position : mInputPosition;
+}
+
+void OverlapSaveCorrelator::correlateSegment(size_t segment, std::complex<float>* buffer)
+{
+    const size_t size = mFft.size();
+    const auto input = mInput.data() + segment * mStep;
+
+    std::copy(input, input + size, buffer);
+    mFft.forward(buffer);
+    for (size_t i = 0; i < size; ++i) buffer[i] *= mReferenceSpectrum[i];
+    mFft.inverse(buffer);
+
+    // Circular correlation is valid where the reference does not wrap
+    std::copy(buffer, buffer + mStep, mCorrelation.begin() + segment * mStep);
+
+    double energy = 0;
+    for (size_t k = 0; k < mLength; ++k) energy += std::norm(input[k]);
+
+    auto output = mEnergy.begin() + segment * mStep;
+    for (size_t m = 0; m < mStep; ++m)
+    {
+        output[m] = std::max(energy, 0.0);
+        if (m + 1 < mStep) energy += std::norm(input[m + mLength]) - std::norm(input[m]);
+    }
+}
+
+void OverlapSaveCorrelator::pickPeaks(size_t outputs, std::vector<Detection>& detections)
+{
+    for (size_t m = 0; m < outputs; ++m)
+    {
+        const quint64 position = mInputPosition + m;
+
+        // The strongest output within one reference length after the
+        // threshold crossing wins, the next one after it is ignored
+        if (mInPeak and position >= mPeakDeadline)
+        {
+            detections.push_back(mPeak);
+            mHoldUntil = mPeak.position + mLength;
+            mInPeak = false;
+        }
+
+        if (position < mHoldUntil) continue;
+
+        const double energy = mEnergy[m];
+        if (energy <= 0 or mReferenceEnergy <= 0) continue;
+
+        const float metric = std::norm(mCorrelation[m]) / (mReferenceEnergy * energy);
+        if (metric < mThreshold) continue;
+
+        if (not mInPeak or metric > mPeak.metric)
+        {
+            if (not mInPeak) mPeakDeadline = position + mLength;
+
+            mInPeak = true;
+            mPeak.position = position;
+            mPeak.metric = metric;
+            mPeak.windowPower = energy / mLength;
+            mPeak.phase = std::arg(mCorrelation[m]);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <complex>
+#include <vector>
+
+#include "Fft.hpp"
+
+class WorkStealingThreadPool;
+
+// Streaming matched filter: correlates interleaved I16 IQ input with a
+// reference sequence by FFT overlap-save. Every FFT segment gives
+// fftSize - referenceLength + 1 outputs and segments are independent, so
+// a block is split across pool workers by segments. Peaks of the
+// normalized correlation above the threshold are reported once per
+// reference length.
+class OverlapSaveCorrelator
+{
+public:
+    struct Detection
+    {
+        quint64 position = 0;   // first sample of the match since the stream start
+        float metric = 0;       // |correlation|^2 / (reference energy * window energy), 0..1
+        float windowPower = 0;  // mean I^2 + Q^2 of the matched window
+        float phase = 0;        // radians, input relative to the reference
+    };
+
+    static size_t defaultFftSize(size_t referenceLength);
+
+public:
+    // fftSize = 0 picks defaultFftSize()
+    OverlapSaveCorrelator(const std::vector<std::complex<float>>& reference, float threshold,
+                          size_t fftSize = 0);
+
+    size_t referenceLength() const;
+    size_t fftSize() const;
+
+    // Appends detections found so far, returns correlation outputs computed.
+    // Input not filling a whole segment is kept for the next call.
+    size_t process(const qint16* samples, size_t count, std::vector<Detection>& detections,
+                   WorkStealingThreadPool* pool = nullptr);
+
+    // Reports the peak still waiting for its neighbourhood at the stream end
+    void finish(std::vector<Detection>& detections);
+
+    // Earliest position a future detection can have
+    quint64 pendingFrom() const;
+
+private:
+    void correlateSegment(size_t segment, std::complex<float>* buffer);
+    void pickPeaks(size_t outputs, std::vector<Detection>& detections);
+
+private:
+    size_t mLength;
+    Fft mFft;
+    size_t mStep;
+    float mThreshold;
+
+    // conj(FFT(reference)) / fftSize
+    std::vector<std::complex<float>> mReferenceSpectrum;
+    double mReferenceEnergy = 0;
+
+    // Unconsumed input, the first sample is at mInputPosition
+    std::vector<std::complex<float>> mInput;
+    quint64 mInputPosition = 0;
+
+    // Outputs of the current call: correlation and window energy
+    std::vector<std::complex<float>> mCorrelation;
+    std::vector<double> mEnergy;
+
+    bool mInPeak = false;
+    Detection mPeak;
+    quint64 mPeakDeadline = 0;
+    quint64 mHoldUntil = 0;
+};
@@ -0,0 +1,125 @@
+#include <cmath>
+
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "PolyphaseChannelizer.hpp"
+
+inline const size_t FramesPerTask = 64;
+
+inline qint16 SaturateSample(float value)
+{
+    return static_cast<qint16>(qBound(-32768.0f, std::nearbyint(value), 32767.0f));
+}
+
+PolyphaseChannelizer::PolyphaseChannelizer(unsigned channels, unsigned tapsPerChannel)
+    : mChannels(channels)
+    , mTapsPerChannel(tapsPerChannel ? tapsPerChannel : 1)
+    , mFft(channels)
+{
+    const size_t length = mChannels * mTapsPerChannel;
+    std::vector<double> prototype(length);
+    double sum = 0;
+
+    // Windowed sinc with cutoff at half of the channel spacing
+    for (size_t n = 0; n < length; ++n)
+    {
+        const double x = (n - (length - 1) / 2.0) / mChannels;
+        const double sinc = (x == 0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        const double phase = 2 * M_PI * n / (length - 1 ? length - 1 : 1);
+        const double blackman = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase);
+
+        prototype[n] = sinc * blackman;
+        sum += prototype[n];
+    }
+
+    mFilter.resize(length);
+    for (size_t row = 0; row < mTapsPerChannel; ++row)
+    {
+        for (size_t q = 0; q < mChannels; ++q)
+        {
+            mFilter[row * mChannels + q] = prototype[row * mChannels + (mChannels - 1 - q)] / sum;
+        }
+    }
+
+    // First frame uses N new samples and zero history
+    mInput.assign((length - mChannels) * 2, 0.0f);
+}
+
+unsigned PolyphaseChannelizer::channels() const
+{
+    return mChannels;
+}
+
+size_t PolyphaseChannelizer::process(const qint16* samples, size_t count, QVector<QByteArray>& outputs,
+                                     WorkStealingThreadPool* pool)
+{
+    const size_t length = mChannels * mTapsPerChannel;
+    const size_t historySize = mInput.size();
+
+    mInput.resize(historySize + count * 2);
+    for (size_t i = 0; i < count * 2; ++i) mInput[historySize + i] = samples[i];
+
+    const size_t available = mInput.size() / 2;
+    const size_t frames = (available >= length) ? (available - length) / mChannels + 1 : 0;
+    if (frames == 0) return 0;
+
+    if (outputs.size() not_eq static_cast<int>(mChannels)) outputs.resize(mChannels);
+
+    QVector<qint16*> channelOutputs(mChannels);
+    for (unsigned k = 0; k < mChannels; ++k)
+    {
+        const int offset = outputs[k].size();
+        outputs[k].resize(offset + frames * sizeof(qint16) * 2);
+        channelOutputs[k] = reinterpret_cast<qint16*>(outputs[k].data() + offset);
+    }
+
+    const auto work = [&](size_t begin, size_t end)
+    {
+        std::vector<float> accumulator(mChannels * 2);
+        std::vector<std::complex<float>> spectrum(mChannels);
+
+        for (size_t frame = begin; frame < end; ++frame)
+        {
+            processFrame(frame, accumulator.data(), spectrum.data(), channelOutputs);
+        }
+    };
+
+    if (pool) pool->parallelFor(frames, FramesPerTask, work);
+    else work(0, frames);
+
+    mInput.erase(mInput.begin(), mInput.begin() + frames * mChannels * 2);
+    return frames;
+}
+
+void PolyphaseChannelizer::processFrame(size_t frame, float* accumulator, std::complex<float>* spectrum,
+                                        QVector<qint16*>& outputs) const
+{
+    const size_t width = mChannels * 2;
+    std::fill(accumulator, accumulator + width, 0.0f);
+
+    // Row t multiplies the N samples ending t * N samples before the newest
+    for (size_t row = 0; row < mTapsPerChannel; ++row)
+    {
+        const float* input = mInput.data() + (frame + mTapsPerChannel - 1 - row) * width;
+        const float* filter = mFilter.data() + row * mChannels;
+
+        for (size_t q = 0; q < mChannels; ++q)
+        {
+            accumulator[q * 2] += filter[q] * input[q * 2];
+            accumulator[q * 2 + 1] += filter[q] * input[q * 2 + 1];
+        }
+    }
+
+    for (size_t p = 0; p < mChannels; ++p)
+    {
+        const size_t q = mChannels - 1 - p;
+        spectrum[p] = std::complex<float>(accumulator[q * 2], accumulator[q * 2 + 1]);
+    }
+
+    mFft.inverse(spectrum);
+
+    for (size_t k = 0; k < mChannels; ++k)
+    {
+        outputs[k][frame * 2] = SaturateSample(spectrum[k].real());
+        outputs[k][frame * 2 + 1] = SaturateSample(spectrum[k].imag());
+    }
+}
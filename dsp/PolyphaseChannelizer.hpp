@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QVector>
+#include <QByteArray>
+
+#include <vector>
+
+#include "Fft.hpp"
+
+class WorkStealingThreadPool;
+
+// Critically sampled FFT filter bank: splits interleaved I16 IQ input into
+// N channels spaced by sampleRate / N, each decimated by N. Channel k is
+// centered at k * sampleRate / N, channels above N / 2 are the negative
+// frequencies. Output frames are independent, so a block is split across
+// pool workers by frames.
+class PolyphaseChannelizer
+{
+public:
+    // channels must be a power of two
+    explicit PolyphaseChannelizer(unsigned channels, unsigned tapsPerChannel = 8);
+
+    unsigned channels() const;
+
+    // Appends I16 samples of channel k to outputs[k], returns frames produced.
+    // Input not filling a whole frame is kept for the next call.
+    size_t process(const qint16* samples, size_t count, QVector<QByteArray>& outputs,
+                   WorkStealingThreadPool* pool = nullptr);
+
+private:
+    void processFrame(size_t frame, float* accumulator, std::complex<float>* spectrum,
+                      QVector<qint16*>& outputs) const;
+
+private:
+    unsigned mChannels;
+    unsigned mTapsPerChannel;
+    Fft mFft;
+
+    // Prototype filter split into tapsPerChannel rows of N coefficients,
+    // every row reversed so the inner loop walks input and filter forward
+    std::vector<float> mFilter;
+
+    // Interleaved float IQ: filter history followed by unconsumed input
+    std::vector<float> mInput;
+};
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "RationalResampler.hpp"
+
+// Cutoff relative to the narrower of input and output Nyquist bands
+inline const double CutoffFraction = 0.9;
+
+bool RationalResampler::ratio(quint64 inputRate, quint64 outputRate, unsigned maxFactor,
+                              unsigned& interpolation, unsigned& decimation)
+{
+    if (inputRate == 0 or outputRate == 0) return false;
+
+    const quint64 divisor = std::gcd(inputRate, outputRate);
+    if (outputRate / divisor > maxFactor or inputRate / divisor > maxFactor) return false;
+
+    interpolation = outputRate / divisor;
+    decimation = inputRate / divisor;
+    return true;
+}
+
+RationalResampler::RationalResampler(unsigned interpolation, unsigned decimation, unsigned tapsPerPhase)
+    : mInterpolation(interpolation ? interpolation : 1)
+    , mDecimation(decimation ? decimation : 1)
+{
+    // Decimating filter gets longer with the narrower cutoff
+    const unsigned widest = std::max(mInterpolation, mDecimation);
+    mTapsPerPhase = (size_t(std::max(tapsPerPhase, 1u)) * widest + mInterpolation - 1) / mInterpolation;
+    mTapsPerPhase += mTapsPerPhase % 2;
+
+    const size_t length = size_t(mInterpolation) * mTapsPerPhase;
+    const double cutoff = CutoffFraction * 0.5 / widest;
+    std::vector<double> prototype(length);
+    double sum = 0;
+
+    // Windowed sinc at the upsampled rate
+    for (size_t n = 0; n < length; ++n)
+    {
+        const double x = 2 * cutoff * (n - (length - 1) / 2.0);
+        const double sinc = (x == 0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        const double phase = 2 * M_PI * n / (length - 1 ? length - 1 : 1);
+        const double blackman = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase);
+
+        prototype[n] = sinc * blackman;
+        sum += prototype[n];
+    }
+
+    // Every phase sees one of L upsampled samples, so the gain is L
+    mFilters.resize(length * 2);
+    for (unsigned phase = 0; phase < mInterpolation; ++phase)
+    {
+        float* filter = mFilters.data() + size_t(phase) * mTapsPerPhase * 2;
+        for (unsigned k = 0; k < mTapsPerPhase; ++k)
+        {
+            const auto tap = float(prototype[phase + size_t(k) * mInterpolation] * mInterpolation / sum);
+            const unsigned j = mTapsPerPhase - 1 - k;
+            filter[j * 2] = tap;
+            filter[j * 2 + 1] = tap;
+        }
+    }
+
+    reset();
+}
+
+unsigned RationalResampler::interpolation() const
+{
+    return mInterpolation;
+}
+
+unsigned RationalResampler::decimation() const
+{
+    return mDecimation;
+}
+
+size_t RationalResampler::process(const float* input, size_t count, std::vector<float>& output)
+{
+    mInput.insert(mInput.end(), input, input + count * 2);
+
+    const size_t available = mInput.size() / 2;
+    const size_t first = output.size();
+    const size_t width = size_t(mTapsPerPhase) * 2;
+
+    // Output n sits at n * M of the upsampled stream: phase (n * M) % L,
+    // newest input sample (n * M) / L
+    const size_t estimate = (available > mPosition) ? (available - mPosition) * mInterpolation / mDecimation + 1 : 0;
+    output.reserve(first + estimate * 2);
+
+    float sample[2];
+    while (mPosition < available)
+    {
+        filterSample(mInput.data() + (mPosition + 1 - mTapsPerPhase) * 2,
+                     mFilters.data() + size_t(mPhase) * width, sample);
+        output.push_back(sample[0]);
+        output.push_back(sample[1]);
+
+        mPhase += mDecimation;
+        mPosition += mPhase / mInterpolation;
+        mPhase %= mInterpolation;
+    }
+
+    // Keep the history of the next output
+    const size_t drop = std::min(mPosition + 1 - mTapsPerPhase, available);
+    mInput.erase(mInput.begin(), mInput.begin() + drop * 2);
+    mPosition -= drop;
+
+    return (output.size() - first) / 2;
+}
+
+void RationalResampler::reset()
+{
+    mInput.assign(size_t(mTapsPerPhase - 1) * 2, 0.0f);
+    mPosition = mTapsPerPhase - 1;
+    mPhase = 0;
+}
+
+void RationalResampler::filterSample(const float* input, const float* filter, float* output) const
+{
+    const size_t width = size_t(mTapsPerPhase) * 2;
+    size_t i = 0;
+
+#ifdef __SSE__
+    // Lanes hold I Q I Q of two neighbour taps
+    __m128 sum = _mm_setzero_ps();
+    for (; i + 4 <= width; i += 4)
+    {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(input + i), _mm_loadu_ps(filter + i)));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    output[0] = lanes[0] + lanes[2];
+    output[1] = lanes[1] + lanes[3];
+#else
+    output[0] = output[1] = 0;
+#endif
+
+    for (; i < width; i += 2)
+    {
+        output[0] += input[i] * filter[i];
+        output[1] += input[i + 1] * filter[i + 1];
+    }
+}
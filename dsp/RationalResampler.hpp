@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Streaming polyphase resampler by interpolation / decimation on interleaved
+// float IQ. The windowed sinc prototype is split into one filter per phase,
+// so only the taps of the needed phase are computed: tapsPerPhase complex
+// multiply-adds per output sample when interpolating, per input sample when
+// decimating. State is kept between calls: a long input can be fed in any
+// chunks and produces the same output as one call.
+class RationalResampler
+{
+public:
+    // Reduces outputRate / inputRate to interpolation / decimation,
+    // fails if either of them exceeds maxFactor
+    static bool ratio(quint64 inputRate, quint64 outputRate, unsigned maxFactor,
+                      unsigned& interpolation, unsigned& decimation);
+
+public:
+    RationalResampler(unsigned interpolation, unsigned decimation, unsigned tapsPerPhase = 16);
+
+    unsigned interpolation() const;
+    unsigned decimation() const;
+
+    // Appends resampled samples to output, returns samples produced
+    size_t process(const float* input, size_t count, std::vector<float>& output);
+
+    // Forgets the history, next call starts from silence
+    void reset();
+
+private:
+    void filterSample(const float* input, const float* filter, float* output) const;
+
+private:
+    unsigned mInterpolation;
+    unsigned mDecimation;
+    unsigned mTapsPerPhase;
+
+    // Per phase taps, reversed and duplicated for I and Q: h0 h0 h1 h1 ...
+    std::vector<float> mFilters;
+
+    // Interleaved float IQ: filter history followed by unconsumed input
+    std::vector<float> mInput;
+    size_t mPosition = 0;   // newest input sample of the next output
+    unsigned mPhase = 0;
+};
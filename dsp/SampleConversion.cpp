@@ -0,0 +1,167 @@
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "SampleConversion.hpp"
+
+inline const float F32Scale = 32767.0f;
+inline const float I8Scale = 256.0f;
+
+bool ParseSampleFormat(const QString& name, SampleFormat& format)
+{
+    if (name == "i16") format = SampleFormat::I16;
+    else if (name == "f32") format = SampleFormat::F32;
+    else if (name == "i8") format = SampleFormat::I8;
+    else return false;
+
+    return true;
+}
+
+const char* SampleFormatName(SampleFormat format)
+{
+    switch (format)
+    {
+    case SampleFormat::I16: return "i16";
+    case SampleFormat::F32: return "f32";
+    case SampleFormat::I8: return "i8";
+    default: return "unknown";
+    }
+}
+
+size_t SampleFormatSize(SampleFormat format)
+{
+    switch (format)
+    {
+    case SampleFormat::I16: return sizeof(qint16) * 2;
+    case SampleFormat::F32: return sizeof(float) * 2;
+    case SampleFormat::I8: return sizeof(qint8) * 2;
+    default: return 0;
+    }
+}
+
+void ConvertToFloat(const char* input, SampleFormat format, size_t count, float* output)
+{
+    const size_t values = count * 2;
+    size_t i = 0;
+
+    switch (format)
+    {
+    case SampleFormat::I16:
+    {
+        const auto samples = reinterpret_cast<const qint16*>(input);
+
+#ifdef __SSE2__
+        for (; i + 8 <= values; i += 8)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+            _mm_storeu_ps(output + i, _mm_cvtepi32_ps(low));
+            _mm_storeu_ps(output + i + 4, _mm_cvtepi32_ps(high));
+        }
+#endif
+
+        for (; i < values; ++i) output[i] = samples[i];
+        break;
+    }
+    case SampleFormat::F32:
+    {
+        const auto samples = reinterpret_cast<const float*>(input);
+
+#ifdef __SSE2__
+        const __m128 scale = _mm_set1_ps(F32Scale);
+        for (; i + 4 <= values; i += 4)
+        {
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+        }
+#endif
+
+        for (; i < values; ++i) output[i] = samples[i] * F32Scale;
+        break;
+    }
+    case SampleFormat::I8:
+    {
+        const auto samples = reinterpret_cast<const qint8*>(input);
+
+#ifdef __SSE2__
+        // Bytes go into the high half of 16 bits, which is the x256 scaling
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= values; i += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128i words[] = { _mm_unpacklo_epi8(zero, x), _mm_unpackhi_epi8(zero, x) };
+
+            for (int w = 0; w < 2; ++w)
+            {
+                const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(words[w], words[w]), 16);
+                const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(words[w], words[w]), 16);
+
+                _mm_storeu_ps(output + i + w * 8, _mm_cvtepi32_ps(low));
+                _mm_storeu_ps(output + i + w * 8 + 4, _mm_cvtepi32_ps(high));
+            }
+        }
+#endif
+
+        for (; i < values; ++i) output[i] = samples[i] * I8Scale;
+        break;
+    }
+    }
+}
+
+void ConvertToI16(const float* input, size_t count, float gain, qint16* output)
+{
+    const size_t values = count * 2;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Clamp before conversion: out of range floats convert to INT_MIN
+    const __m128 scale = _mm_set1_ps(gain);
+    const __m128 minimum = _mm_set1_ps(-32768.0f);
+    const __m128 maximum = _mm_set1_ps(32767.0f);
+
+    const auto convert = [&](const float* source)
+    {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(source), scale);
+        return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(x, minimum), maximum));
+    };
+
+    for (; i + 8 <= values; i += 8)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                         _mm_packs_epi32(convert(input + i), convert(input + i + 4)));
+    }
+#endif
+
+    for (; i < values; ++i)
+    {
+        output[i] = static_cast<qint16>(qBound(-32768.0f, std::nearbyint(input[i] * gain), 32767.0f));
+    }
+}
+
+void ConvertFromI16(const qint16* input, size_t count, SampleFormat format, char* output)
+{
+    const size_t values = count * 2;
+
+    switch (format)
+    {
+    case SampleFormat::I16:
+        std::memcpy(output, input, values * sizeof(qint16));
+        break;
+    case SampleFormat::F32:
+    {
+        const auto samples = reinterpret_cast<float*>(output);
+        for (size_t i = 0; i < values; ++i) samples[i] = input[i] / F32Scale;
+        break;
+    }
+    case SampleFormat::I8:
+    {
+        const auto samples = reinterpret_cast<qint8*>(output);
+        for (size_t i = 0; i < values; ++i) samples[i] = static_cast<qint8>(qMin((input[i] + 128) >> 8, 127));
+        break;
+    }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QString>
+
+#include <cstddef>
+
+// Interleaved IQ sample formats of TX files. Float samples between the
+// conversions are kept in I16 units: f32 full scale 1.0 maps to 32767.
+enum class SampleFormat
+{
+    I16,
+    F32,
+    I8
+};
+
+bool ParseSampleFormat(const QString& name, SampleFormat& format);
+const char* SampleFormatName(SampleFormat format);
+
+// Bytes per complex sample
+size_t SampleFormatSize(SampleFormat format);
+
+void ConvertToFloat(const char* input, SampleFormat format, size_t count, float* output);
+
+// Scales by gain, rounds and saturates to I16
+void ConvertToI16(const float* input, size_t count, float gain, qint16* output);
+
+// Writes I16 samples as format, output holds count * SampleFormatSize(format) bytes
+void ConvertFromI16(const qint16* input, size_t count, SampleFormat format, char* output);
@@ -1,15 +1,37 @@
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <QElapsedTimer>
 
+#include <cmath>
 #include <cstring>
 
 #include "types/RxMissionConfig.hpp"
 #include "types/TxMissionConfig.hpp"
+#include "dsp/AgcController.hpp"
+#include "dsp/BlockStatistics.hpp"
+#include "ipc/SharedMemoryRing.hpp"
+#include "pipeline/Pipeline.hpp"
+#include "pipeline/SampleBlockPool.hpp"
+#include "playback/TxFileSource.hpp"
+#include "stages/CallbackStage.hpp"
+#include "stages/ChannelizerStage.hpp"
+#include "stages/CircularRecorderStage.hpp"
+#include "stages/FileRecorderStage.hpp"
+#include "stages/IqCorrectionStage.hpp"
+#include "stages/PreambleDetectorStage.hpp"
+#include "stages/RecordingIndexStage.hpp"
+#include "stages/SharedMemoryStage.hpp"
+#include "tracing/Tracer.hpp"
 #include "LimeSDRDevice.hpp"
 
-inline const quint16 SampleSize = sizeof(quint16) * 2;
 inline const quint16 ErrorMaxCount = 5;
+inline const quint32 RxPipelineCapacity = 64;
+// RX FIFO depth: blocks received after a gain change may be captured before it
+inline const quint32 RxFifoBlocks = 2;
+// Blocks held outside the pipeline queues: signal receivers, short stage
+// history; the preamble detector history is added from the mission config
+inline const quint32 RxPoolSpareBlocks = 16;
 
 inline void SameLinePrint(const QString& data)
 {
@@ -19,10 +41,11 @@ inline void SameLinePrint(const QString& data)
 
 QList<LimeSDRDevice*> LimeSDRDevice::availableDevicesList()
 {
+    TRACE_SCOPE("LimeSDRDevice::availableDevicesList");
     lms_info_str_t* devices = nullptr;
     QList<LimeSDRDevice*> result;
 
-    const auto count = LMS_GetDeviceList(devices);
+    const auto count = TRACE_CALL(LMS_GetDeviceList, devices);
     if (count <= 0)
     {
         qWarning("No limeSDR devices found! Exiting...");
@@ -86,6 +109,7 @@ LimeSDRDevice::~LimeSDRDevice()
 
 bool LimeSDRDevice::init(lms_info_str_t* initStr)
 {
+    TRACE_SCOPE("LimeSDRDevice::init");
     const lms_dev_info_t* deviceInformation = nullptr;
 
     if (mDevice not_eq nullptr)
@@ -95,7 +119,7 @@ bool LimeSDRDevice::init(lms_info_str_t* initStr)
         return false;
     }
 
-    if (LMS_Open(&mDevice, *initStr, NULL) not_eq 0)
+    if (TRACE_CALL(LMS_Open, &mDevice, *initStr, NULL) not_eq 0)
     {
         qWarning("[LimeSDRDevice] Device open error.");
         return false;
@@ -115,7 +139,7 @@ bool LimeSDRDevice::init(lms_info_str_t* initStr)
     mRxStreams.resize(LMS_GetNumChannels(mDevice, RX));
     mTxStreams.resize(LMS_GetNumChannels(mDevice, TX));
 
-    if (LMS_Init(mDevice) not_eq 0)
+    if (TRACE_CALL(LMS_Init, mDevice) not_eq 0)
     {
         qWarning("[LimeSDRDevice] Failed to init device.");
         LMS_Close(mDevice);
@@ -133,11 +157,19 @@ quint64 LimeSDRDevice::deviceIdentificator() const
 
 bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
 {
+    TRACE_SCOPE("LimeSDRDevice::startRxMission");
     if (mRxStreams.at(config.channelNumber)) return false;
 
+    mRxPreamble.clear();
+    if (not config.preambleFileName.isEmpty()
+    and not PreambleDetectorStage::loadReference(config.preambleFileName, mRxPreamble))
+    {
+        return false;
+    }
+
     if (not switchChannel(RX, config.channelNumber, true)) return false;
 
-    if (LMS_SetSampleRate(mDevice, config.sampleRate, 0) not_eq 0)
+    if (TRACE_CALL(LMS_SetSampleRate, mDevice, config.sampleRate, 0) not_eq 0)
     {
         switchChannel(RX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting samplerate to %llu: %s!",
@@ -145,7 +177,7 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetLOFrequency(mDevice, RX, config.channelNumber, config.frequency) not_eq 0)
+    if (TRACE_CALL(LMS_SetLOFrequency, mDevice, RX, config.channelNumber, config.frequency) not_eq 0)
     {
         switchChannel(RX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting frequency to %llu: %s!",
@@ -153,7 +185,7 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetAntenna(mDevice, RX, config.channelNumber, config.antenaNumber) not_eq 0)
+    if (TRACE_CALL(LMS_SetAntenna, mDevice, RX, config.channelNumber, config.antenaNumber) not_eq 0)
     {
         switchChannel(RX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting antena: %s!",
@@ -161,7 +193,7 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetGaindB(mDevice, RX, config.channelNumber, config.gain) not_eq 0)
+    if (TRACE_CALL(LMS_SetGaindB, mDevice, RX, config.channelNumber, config.gain) not_eq 0)
     {
         switchChannel(RX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting gain to %u: %s!",
@@ -169,7 +201,7 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
         return false;
     }
 
-    if (LMS_Calibrate(mDevice, RX, config.channelNumber, config.bandwidth, 0) not_eq 0)
+    if (TRACE_CALL(LMS_Calibrate, mDevice, RX, config.channelNumber, config.bandwidth, 0) not_eq 0)
     {
         switchChannel(RX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while calibrating: %s!",
@@ -180,11 +212,11 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
     auto stream = new lms_stream_t;
     stream->dataFmt = lms_stream_t::LMS_FMT_I16;
     stream->channel = config.channelNumber;
-    stream->fifoSize = config.samplesCount * 2;
+    stream->fifoSize = config.samplesCount * RxFifoBlocks;
     stream->isTx = false;
     stream->throughputVsLatency = 1.0;
 
-    if (LMS_SetupStream(mDevice, stream) not_eq 0)
+    if (TRACE_CALL(LMS_SetupStream, mDevice, stream) not_eq 0)
     {
         delete stream;
         switchChannel(RX, config.channelNumber, false);
@@ -193,10 +225,26 @@ bool LimeSDRDevice::startRxMission(const RxMissionConfig& config)
         return false;
     }
 
+    if (not config.sharedMemoryName.isEmpty())
+    {
+        mRxSharedMemory.reset(new SharedMemoryRingWriter);
+        if (not mRxSharedMemory->create(config.sharedMemoryName, config.sharedMemorySlots,
+                                        config.samplesCount * SampleSize,
+                                        config.sampleRate, config.frequency))
+        {
+            mRxSharedMemory.reset();
+            LMS_DestroyStream(mDevice, stream);
+            delete stream;
+            switchChannel(RX, config.channelNumber, false);
+            qWarning("[LimeSDRDevice][%llu] Error while shared memory setup!",
+                     mDeviceIdentificator);
+            return false;
+        }
+    }
+
     mRxStreams[config.channelNumber] = stream;
 
-    mRxThread.reset(new std::thread(&LimeSDRDevice::rxRoutine, this,
-                                    config.channelNumber, config.samplesCount, config.tryCount));
+    mRxThread.reset(new std::thread(&LimeSDRDevice::rxRoutine, this, config));
 
     qDebug("[LimeSDRDevice][%llu] Rx mission created!", mDeviceIdentificator);
     return true;
@@ -209,6 +257,7 @@ void LimeSDRDevice::stopRxMission(quint16 )
 
 bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
 {
+    TRACE_SCOPE("LimeSDRDevice::startTxMission");
     if (mTxStreams.at(config.channelNumber)) return false;
 
     const QFileInfo file(QDir::current().absoluteFilePath("TX") + "/" + config.fileName);
@@ -219,9 +268,14 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
         return false;
     }
 
+    auto source = std::make_shared<TxFileSource>(file.absoluteFilePath(), config.fileFormat,
+                                                 config.fileSampleRate, config.sampleRate,
+                                                 config.digitalGainDb);
+    if (not source->open()) return false;
+
     if (not switchChannel(TX, config.channelNumber, true)) return false;
 
-    if (LMS_SetSampleRate(mDevice, config.sampleRate, 0) not_eq 0)
+    if (TRACE_CALL(LMS_SetSampleRate, mDevice, config.sampleRate, 0) not_eq 0)
     {
         switchChannel(TX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting samplerate to %llu: %s!",
@@ -229,7 +283,7 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetLOFrequency(mDevice, TX, config.channelNumber, config.frequency) not_eq 0)
+    if (TRACE_CALL(LMS_SetLOFrequency, mDevice, TX, config.channelNumber, config.frequency) not_eq 0)
     {
         switchChannel(TX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting frequency to %llu: %s!",
@@ -237,7 +291,7 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetAntenna(mDevice, TX, config.channelNumber, config.antenaNumber) not_eq 0)
+    if (TRACE_CALL(LMS_SetAntenna, mDevice, TX, config.channelNumber, config.antenaNumber) not_eq 0)
     {
         switchChannel(TX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting antena: %s!",
@@ -245,7 +299,7 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
         return false;
     }
 
-    if (LMS_SetGaindB(mDevice, TX, config.channelNumber, config.gain) not_eq 0)
+    if (TRACE_CALL(LMS_SetGaindB, mDevice, TX, config.channelNumber, config.gain) not_eq 0)
     {
         switchChannel(TX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while setting gain to %u: %s!",
@@ -253,7 +307,7 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
         return false;
     }
 
-    if (LMS_Calibrate(mDevice, TX, config.channelNumber, config.bandwidth, 0) not_eq 0)
+    if (TRACE_CALL(LMS_Calibrate, mDevice, TX, config.channelNumber, config.bandwidth, 0) not_eq 0)
     {
         switchChannel(TX, config.channelNumber, false);
         qWarning("[LimeSDRDevice][%llu] Error while calibrating: %s!",
@@ -264,11 +318,11 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
     auto stream = new lms_stream_t;
     stream->dataFmt = lms_stream_t::LMS_FMT_I16;
     stream->channel = config.channelNumber;
-    stream->fifoSize = file.size() / SampleSize;
+    stream->fifoSize = TxChunkSamples * 4;
     stream->isTx = true;
     stream->throughputVsLatency = 0.5;
 
-    if (LMS_SetupStream(mDevice, stream) not_eq 0)
+    if (TRACE_CALL(LMS_SetupStream, mDevice, stream) not_eq 0)
     {
         delete stream;
         switchChannel(TX, config.channelNumber, false);
@@ -280,7 +334,7 @@ bool LimeSDRDevice::startTxMission(const TxMissionConfig& config)
     mTxStreams[config.channelNumber] = stream;
 
     mTxThread.reset(new std::thread(&LimeSDRDevice::txRoutine, this,
-                                    config.channelNumber, config.tryCount, config.fileName));
+                                    config.channelNumber, config.tryCount, source));
 
     qDebug("[LimeSDRDevice][%llu] Tx mission created!", mDeviceIdentificator);
     return true;
@@ -294,7 +348,7 @@ void LimeSDRDevice::stopTxMission(quint16 )
 bool LimeSDRDevice::switchChannel(ChannelType type, quint16 channel, bool state)
 {
     if (not mDevice) return false;
-    else if (LMS_EnableChannel(mDevice, type, channel, state) not_eq 0)
+    else if (TRACE_CALL(LMS_EnableChannel, mDevice, type, channel, state) not_eq 0)
     {
         qWarning("[LimeSDRDevice][%llu] Error while setting %s%i channel to state '%s': %s!",
                  mDeviceIdentificator,
@@ -329,16 +383,45 @@ void LimeSDRDevice::deinitTxStream(int channel)
     deinitStream(&mTxStreams[channel]);
 }
 
-void LimeSDRDevice::rxRoutine(int streamId, quint32 samplesCount, int recordsCount)
+bool LimeSDRDevice::recoverStream(ChannelType type, lms_stream_t* stream)
+{
+    TRACE_SCOPE("LimeSDRDevice::recoverStream");
+
+    // Stop drops FIFO contents, start reuses the configured stream
+    if (TRACE_CALL(LMS_StopStream, stream) not_eq 0
+     or TRACE_CALL(LMS_StartStream, stream) not_eq 0)
+    {
+        qWarning("[LimeSDRDevice][%llu] %s stream restart error: %s!",
+                 mDeviceIdentificator, channelToString(type), LMS_GetLastErrorMessage());
+        return false;
+    }
+    else return true;
+}
+
+void LimeSDRDevice::rxRoutine(RxMissionConfig config)
 {
+    Tracer::instance().setThreadName("rx");
+
+    const int streamId = config.channelNumber;
+    const quint32 samplesCount = config.samplesCount;
+    int recordsCount = config.tryCount;
     const auto currentFolderName = QDateTime::currentDateTime().toString("dd.MM.yyyy_hh.mm.ss");
     const QString rxLabel = channelToString(RX);
-    const QString fileTemplate = "%1.bin";
-    QByteArray buffer(samplesCount * SampleSize, Qt::Uninitialized);
     QDir dir(QDir::current());
     auto stream = mRxStreams.at(streamId);
     int errorsCounter = 0;
     int currentTry = 0;
+    quint64 blockNumber = 0;
+    QElapsedTimer recoveryTimer;
+    int recoveriesCount = 0;
+    double recoveriesMs = 0;
+    unsigned gain = config.gain;
+    unsigned recordedGain = config.gain;
+    quint64 gainBlock = 0;
+    int gainChangesCount = 0;
+
+    std::unique_ptr<AgcController> agc;
+    if (config.agc) agc = std::make_unique<AgcController>(config.agcTargetDbfs, config.gain);
 
     recordsCount = (recordsCount == 0) ? -1 : recordsCount;
 
@@ -347,8 +430,61 @@ void LimeSDRDevice::rxRoutine(int streamId, quint32 samplesCount, int recordsCou
     dir.mkdir(currentFolderName);
     dir.cd(currentFolderName);
 
+    // Window history of the preamble detector may be far longer than the spare blocks
+    quint32 poolBlocks = RxPipelineCapacity + RxPoolSpareBlocks;
+    if (not mRxPreamble.empty())
+    {
+        const quint64 history = PreambleDetectorStage::historySamples(mRxPreamble.size(), config.preambleWindow);
+        poolBlocks += (history + samplesCount - 1) / samplesCount + 1;
+    }
+
+    SampleBlockPool blockPool(poolBlocks, samplesCount * SampleSize);
+    Pipeline pipeline(RxPipelineCapacity);
+    int samplesSource = Pipeline::Source;
+    if (config.iqCorrection)
+    {
+        samplesSource = pipeline.addStage(std::make_shared<IqCorrectionStage>(blockPool));
+    }
+
+    std::shared_ptr<AbstractPipelineStage> recorder;
+    if (config.ringSeconds)
+    {
+        const quint32 ringBlocks = std::ceil(config.ringSeconds * config.sampleRate / samplesCount);
+        recorder = std::make_shared<CircularRecorderStage>(dir.absolutePath(), ringBlocks,
+                                                           samplesCount * SampleSize);
+        pipeline.addStage(recorder, samplesSource);
+    }
+    else
+    {
+        recorder = std::make_shared<FileRecorderStage>(dir.absolutePath());
+        pipeline.addStage(recorder, samplesSource);
+        pipeline.addStage(std::make_shared<RecordingIndexStage>(dir.absolutePath(),
+                                                                config.sampleRate, config.frequency),
+                          samplesSource);
+    }
+    pipeline.addStage(std::make_shared<CallbackStage>("rxAvailable",
+                      [this](const SampleBlockPtr& block) { emit rxAvailable(block); }),
+                      samplesSource);
+    if (mRxSharedMemory)
+    {
+        pipeline.addStage(std::make_shared<SharedMemoryStage>(*mRxSharedMemory), samplesSource);
+    }
+    if (not mRxPreamble.empty())
+    {
+        pipeline.addStage(std::make_shared<PreambleDetectorStage>(dir.absolutePath(), mRxPreamble,
+                                                                  config.preambleThreshold,
+                                                                  config.preambleWindow,
+                                                                  config.sampleRate),
+                          samplesSource);
+    }
+    if (config.channelsCount)
+    {
+        pipeline.addStage(std::make_shared<ChannelizerStage>(dir.absolutePath(), config.channelsCount),
+                          samplesSource);
+    }
+
     mRxThreadFlag.store(true);
-    LMS_StartStream(stream);
+    TRACE_CALL(LMS_StartStream, stream);
 
     qDebug("[LimeSDRDevice][%llu] Rx mission started!", mDeviceIdentificator);
     emit rxStarted();
@@ -356,93 +492,225 @@ void LimeSDRDevice::rxRoutine(int streamId, quint32 samplesCount, int recordsCou
     while (mRxThreadFlag.load()
       and  recordsCount not_eq currentTry)
     {
-        const int captured = LMS_RecvStream(stream, buffer.data(), samplesCount, NULL, 1000);
-        if (captured < 0)
+        TRACE_SCOPE("rx block");
+
+        auto block = blockPool.acquire();
+        char* data = block->data.data();
+        quint32 received = 0;
+
+        // Short reads are completed in place. A timeout or an error restarts
+        // the stream, that drops the FIFO, so the partial block is dropped too.
+        while (received < samplesCount
+           and errorsCounter not_eq ErrorMaxCount
+           and mRxThreadFlag.load())
         {
-            qWarning("[LimeSDRDevice][%llu] Rx stream receive error: %s!",
-                     mDeviceIdentificator, LMS_GetLastErrorMessage());
+            const int captured = TRACE_CALL(LMS_RecvStream, stream, data + received * SampleSize,
+                                            samplesCount - received, NULL, 1000);
+            if (captured > 0)
+            {
+                received += captured;
+                continue;
+            }
+
+            if (captured == 0)
+            {
+                qWarning("[LimeSDRDevice][%llu] Rx stream receive timeout!", mDeviceIdentificator);
+            }
+            else
+            {
+                qWarning("[LimeSDRDevice][%llu] Rx stream receive error: %s!",
+                         mDeviceIdentificator, LMS_GetLastErrorMessage());
+            }
+
+            if (not recoveryTimer.isValid()) recoveryTimer.start();
+            received = 0;
 
             ++errorsCounter;
-            if (errorsCounter not_eq ErrorMaxCount) continue;
-            else break;
+            if (errorsCounter == ErrorMaxCount) break;
+
+            // A stream that failed to restart stays stopped, receiving from it is pointless
+            if (not recoverStream(RX, stream))
+            {
+                qWarning("[LimeSDRDevice][%llu] Rx stream is not recovered, mission stopped!",
+                         mDeviceIdentificator);
+                errorsCounter = ErrorMaxCount;
+            }
         }
 
-        QFile output(dir.absoluteFilePath(fileTemplate.arg(currentTry)));
+        if (received < samplesCount) break;
+        if (recorder->errorsCount() >= ErrorMaxCount) break;
 
-        if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        if (recoveryTimer.isValid())
         {
-            qWarning("[LimeSDRDevice][%llu] Rx output write error: %s!",
-                     mDeviceIdentificator, qPrintable(output.errorString()));
+            const double gapMs = recoveryTimer.nsecsElapsed() / 1e6;
+            recoveryTimer.invalidate();
 
-            ++errorsCounter;
-            if (errorsCounter not_eq ErrorMaxCount) continue;
-            else break;
+            ++recoveriesCount;
+            recoveriesMs += gapMs;
+            errorsCounter = 0;
+            block->discontinuity = true;
+
+            // The restart dropped the FIFO with the blocks of the old gain
+            gainBlock = qMin(gainBlock, blockNumber);
+
+            qInfo("[LimeSDRDevice][%llu] Rx stream recovered in %.3f ms.",
+                  mDeviceIdentificator, gapMs);
         }
-        else
-        {
-            output.write(buffer);
-            emit rxAvailable(buffer);
 
-            qDebug("[LimeSDRDevice][%llu] Rx mission %i try.",
-                   mDeviceIdentificator, currentTry);
+        block->number = blockNumber++;
+        block->timestamp = QDateTime::currentMSecsSinceEpoch();
 
-            if (currentTry == INT32_MAX) currentTry = 0;
-            else ++currentTry;
+        // Blocks already in the FIFO at a gain change were captured at the
+        // old gain, the new one is recorded from the first block after them
+        block->gainChanged = (recordedGain not_eq gain and block->number >= gainBlock);
+        if (block->gainChanged) recordedGain = gain;
+        block->gain = recordedGain;
+
+        // Statistics are needed here, before the next block is requested
+        if (agc)
+        {
+            TRACE_SCOPE("rx agc");
+
+            AccumulateBlockStatistics(reinterpret_cast<const qint16*>(block->data.constData()),
+                                      samplesCount, block->statistics);
+            block->hasStatistics = true;
+
+            unsigned newGain = gain;
+            if (agc->update(block->statistics, newGain))
+            {
+                if (TRACE_CALL(LMS_SetGaindB, mDevice, RX, streamId, newGain) not_eq 0)
+                {
+                    qWarning("[LimeSDRDevice][%llu] Error while setting gain to %u: %s!",
+                             mDeviceIdentificator, newGain, LMS_GetLastErrorMessage());
+                }
+                else
+                {
+                    qInfo("[LimeSDRDevice][%llu] Rx AGC: block %llu | mean %.1f dBFS | peak %.1f dBFS | "
+                          "clipped %u | gain %u -> %u dB",
+                          mDeviceIdentificator, block->number,
+                          block->statistics.meanPowerDbfs(), block->statistics.peakPowerDbfs(),
+                          block->statistics.clippedSamples, gain, newGain);
+
+                    agc->applied(newGain);
+                    gain = newGain;
+                    gainBlock = blockNumber + RxFifoBlocks;
+                    ++gainChangesCount;
+                }
+            }
         }
+
+        pipeline.push(block);
+
+        qDebug("[LimeSDRDevice][%llu] Rx mission %i try.",
+               mDeviceIdentificator, currentTry);
+
+        if (currentTry == INT32_MAX) currentTry = 0;
+        else ++currentTry;
     }
 
     deinitRxStream(streamId);
 
+    pipeline.finish();
+    pipeline.printStatistics();
+    blockPool.printStatistics();
+    mRxSharedMemory.reset();
+
+    if (recoveriesCount)
+    {
+        qInfo("[LimeSDRDevice][%llu] Rx stream recovered %i times, %.3f ms lost in total.",
+              mDeviceIdentificator, recoveriesCount, recoveriesMs);
+    }
+
+    if (agc)
+    {
+        qInfo("[LimeSDRDevice][%llu] Rx AGC changed gain %i times, final gain %u dB.",
+              mDeviceIdentificator, gainChangesCount, gain);
+    }
+
     qDebug("[LimeSDRDevice][%llu] Rx mission finished.", mDeviceIdentificator);
     emit rxFinished();
 }
 
-void LimeSDRDevice::txRoutine(int streamId, int transmissionsCount, const QString& fileName)
+void LimeSDRDevice::txRoutine(int streamId, int transmissionsCount, std::shared_ptr<TxFileSource> source)
 {
-    QFile input(QDir::current().absoluteFilePath("TX") + "/" + fileName);
+    Tracer::instance().setThreadName("tx");
+
     auto stream = mTxStreams.at(streamId);
     int errorsCounter = 0;
     int currentTry = 0;
     QByteArray buffer;
+    QElapsedTimer recoveryTimer;
+    int recoveriesCount = 0;
+    double recoveriesMs = 0;
 
     transmissionsCount = (transmissionsCount == 0) ? -1 : transmissionsCount;
 
-    if (not input.open(QIODevice::ReadOnly))
-    {
-        qWarning("[LimeSDRDevice][%llu] Tx file read error: %s!",
-                 mDeviceIdentificator, qPrintable(input.errorString()));
-        deinitTxStream(streamId);
-        return;
-    }
-    else
-    {
-        buffer = input.readAll();
-        input.close();
-    }
-
-    const auto samplesCount = buffer.size() / SampleSize;
-    const auto oneTransmissionSize = samplesCount;
-
     mTxThreadFlag.store(true);
-    LMS_StartStream(stream);
+    TRACE_CALL(LMS_StartStream, stream);
 
     qDebug("[LimeSDRDevice][%llu] Tx mission started!", mDeviceIdentificator);
     emit txStarted();
 
     while (mTxThreadFlag.load()
-      and  transmissionsCount not_eq currentTry)
+      and  transmissionsCount not_eq currentTry
+      and  errorsCounter not_eq ErrorMaxCount
+      and  source->rewind())
     {
-        const auto sent = LMS_SendStream(stream, buffer.data(), oneTransmissionSize, NULL, INT_MAX);
-        if (sent not_eq oneTransmissionSize)
-        {
-            qWarning("[LimeSDRDevice][%llu] Tx error: %s!",
-                     mDeviceIdentificator, LMS_GetLastErrorMessage());
+        TRACE_SCOPE("tx transmission");
 
-            ++errorsCounter;
-            if (errorsCounter not_eq ErrorMaxCount) continue;
-            else break;
+        while (mTxThreadFlag.load()
+          and  errorsCounter not_eq ErrorMaxCount
+          and  source->read(buffer))
+        {
+            const int chunkSize = buffer.size() / SampleSize;
+            int transmitted = 0;
+
+            // A partial send goes on with the rest, a send error restarts the
+            // stream and retries the samples not sent yet
+            while (transmitted < chunkSize and mTxThreadFlag.load())
+            {
+                const auto sent = TRACE_CALL(LMS_SendStream, stream, buffer.constData() + transmitted * SampleSize,
+                                             chunkSize - transmitted, NULL, INT_MAX);
+                if (sent > 0)
+                {
+                    transmitted += sent;
+                    continue;
+                }
+
+                qWarning("[LimeSDRDevice][%llu] Tx error: %s!",
+                         mDeviceIdentificator, LMS_GetLastErrorMessage());
+
+                if (not recoveryTimer.isValid()) recoveryTimer.start();
+
+                ++errorsCounter;
+                if (errorsCounter == ErrorMaxCount) break;
+
+                // A failed restart ends the mission like ErrorMaxCount errors do
+                if (not recoverStream(TX, stream))
+                {
+                    qWarning("[LimeSDRDevice][%llu] Tx stream is not recovered, mission stopped!",
+                             mDeviceIdentificator);
+                    errorsCounter = ErrorMaxCount;
+                    break;
+                }
+            }
+
+            if (recoveryTimer.isValid() and errorsCounter not_eq ErrorMaxCount)
+            {
+                const double gapMs = recoveryTimer.nsecsElapsed() / 1e6;
+                recoveryTimer.invalidate();
+
+                ++recoveriesCount;
+                recoveriesMs += gapMs;
+                errorsCounter = 0;
+
+                qInfo("\n[LimeSDRDevice][%llu] Tx stream recovered in %.3f ms.",
+                      mDeviceIdentificator, gapMs);
+            }
         }
 
+        if (source->failed()) break;
+
         //qDebug("[LimeSDRDevice][%llu] Tx mission %i try.",
         //       mDeviceIdentificator, currentTry);
 
@@ -471,6 +739,12 @@ void LimeSDRDevice::txRoutine(int streamId, int transmissionsCount, const QStrin
 
     deinitTxStream(streamId);
 
+    if (recoveriesCount)
+    {
+        qInfo("\n[LimeSDRDevice][%llu] Tx stream recovered %i times, %.3f ms lost in total.",
+              mDeviceIdentificator, recoveriesCount, recoveriesMs);
+    }
+
     qDebug("\n[LimeSDRDevice][%llu] Tx mission finished.", mDeviceIdentificator);
     emit txFinished();
 }
@@ -5,11 +5,17 @@
 
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include <complex>
 
 #include "lime/LimeSuite.h"
+#include "pipeline/SampleBlock.hpp"
 
 struct RxMissionConfig;
 struct TxMissionConfig;
+class SharedMemoryRingWriter;
+class TxFileSource;
 
 class LimeSDRDevice : public QObject
 {
@@ -38,7 +44,9 @@ public:
 
 signals:
     void rxStarted();
-    void rxAvailable(const QByteArray& data);
+    // Block stays valid while the handle is held, dropping it returns
+    // the buffer to the capture pool
+    void rxAvailable(SampleBlockPtr block);
     void rxFinished();
 
     void txStarted();
@@ -49,9 +57,11 @@ private:
     void deinitStream(lms_stream_t** stream);
     void deinitRxStream(int channel);
     void deinitTxStream(int channel);
+    // Restarts the stream keeping tuning, calibration and stream buffers
+    bool recoverStream(ChannelType type, lms_stream_t* stream);
 
-    void rxRoutine(int streamId, quint32 samplesCount, int recordsCount);
-    void txRoutine(int streamId, int transmissionsCount, const QString& fileName);
+    void rxRoutine(RxMissionConfig config);
+    void txRoutine(int streamId, int transmissionsCount, std::shared_ptr<TxFileSource> source);
 
     const char* channelToString(ChannelType type) const;
     const char* stateToString(bool state) const;
@@ -60,6 +70,8 @@ private:
     lms_device_t* mDevice = nullptr;
     QVector<lms_stream_t*> mRxStreams;
     QVector<lms_stream_t*> mTxStreams;
+    std::unique_ptr<SharedMemoryRingWriter> mRxSharedMemory;
+    std::vector<std::complex<float>> mRxPreamble;
 
     // TODO: more then one rx/tx thread
     std::unique_ptr<std::thread> mRxThread = nullptr;
@@ -0,0 +1,352 @@
+#include <new>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SharedMemoryRing.hpp"
+
+inline const quint32 RingMagic = 0x4C4D5352; // "LMSR"
+inline const quint32 RingVersion = 1;
+inline const size_t RingAlignment = 64;
+
+inline size_t AlignedSize(size_t size)
+{
+    return (size + RingAlignment - 1) / RingAlignment * RingAlignment;
+}
+
+inline size_t SlotStride(quint32 slotSize)
+{
+    return AlignedSize(sizeof(SharedMemoryRingSlot) + slotSize);
+}
+
+inline size_t RingSize(quint32 slotsCount, quint32 slotSize)
+{
+    return AlignedSize(sizeof(SharedMemoryRingHeader)) + slotsCount * SlotStride(slotSize);
+}
+
+inline QByteArray ShmName(const QString& name)
+{
+    return (name.startsWith('/') ? name : "/" + name).toLocal8Bit();
+}
+
+SharedMemoryRingWriter::~SharedMemoryRingWriter()
+{
+    destroy();
+}
+
+bool SharedMemoryRingWriter::create(const QString& name, quint32 slotsCount, quint32 slotSize,
+                                    quint64 sampleRate, quint64 frequency)
+{
+    if (isOpen()) destroy();
+
+    if (slotsCount == 0 or slotSize == 0)
+    {
+        qWarning("[SharedMemoryRing] Invalid ring geometry: %u slots of %u bytes!",
+                 slotsCount, slotSize);
+        return false;
+    }
+
+    const auto shmName = ShmName(name);
+    const auto size = RingSize(slotsCount, slotSize);
+
+    const int fd = shm_open(shmName.constData(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        qWarning("[SharedMemoryRing] shm_open '%s' error: %s!",
+                 shmName.constData(), strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, size) not_eq 0)
+    {
+        qWarning("[SharedMemoryRing] ftruncate '%s' error: %s!",
+                 shmName.constData(), strerror(errno));
+        ::close(fd);
+        shm_unlink(shmName.constData());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        qWarning("[SharedMemoryRing] mmap '%s' error: %s!",
+                 shmName.constData(), strerror(errno));
+        shm_unlink(shmName.constData());
+        return false;
+    }
+
+    mName = name;
+    mMemory = static_cast<char*>(memory);
+    mMemorySize = size;
+    mHeader = new (mMemory) SharedMemoryRingHeader;
+    mHeader->magic.store(0, std::memory_order_relaxed);
+    mHeader->version = RingVersion;
+    mHeader->slotsCount = slotsCount;
+    mHeader->slotSize = slotSize;
+    mHeader->sampleRate = sampleRate;
+    mHeader->frequency = frequency;
+    mHeader->published.store(0, std::memory_order_relaxed);
+
+    for (quint32 i = 0; i < slotsCount; ++i)
+    {
+        auto slotHeader = new (slot(i)) SharedMemoryRingSlot;
+        slotHeader->sequence.store(0, std::memory_order_relaxed);
+        slotHeader->size = 0;
+        slotHeader->timestamp = 0;
+    }
+
+    // Readers check magic first, so it must be published after the rest
+    mHeader->magic.store(RingMagic, std::memory_order_release);
+
+    qDebug("[SharedMemoryRing] Ring '%s' created: %u slots of %u bytes.",
+           shmName.constData(), slotsCount, slotSize);
+    return true;
+}
+
+void SharedMemoryRingWriter::destroy()
+{
+    if (not isOpen()) return;
+
+    munmap(mMemory, mMemorySize);
+    shm_unlink(ShmName(mName).constData());
+
+    mHeader = nullptr;
+    mMemory = nullptr;
+    mMemorySize = 0;
+    mName.clear();
+}
+
+bool SharedMemoryRingWriter::isOpen() const
+{
+    return mHeader not_eq nullptr;
+}
+
+quint64 SharedMemoryRingWriter::published() const
+{
+    return isOpen() ? mHeader->published.load(std::memory_order_relaxed) : 0;
+}
+
+bool SharedMemoryRingWriter::publish(const char* data, quint32 size, qint64 timestamp)
+{
+    if (not isOpen() or size > mHeader->slotSize) return false;
+
+    const auto sequence = mHeader->published.load(std::memory_order_relaxed);
+    auto target = slot(sequence);
+
+    target->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(reinterpret_cast<char*>(target) + sizeof(SharedMemoryRingSlot), data, size);
+    target->size = size;
+    target->timestamp = timestamp;
+
+    target->sequence.store(sequence + 1, std::memory_order_release);
+    mHeader->published.store(sequence + 1, std::memory_order_release);
+    return true;
+}
+
+SharedMemoryRingSlot* SharedMemoryRingWriter::slot(quint64 sequence) const
+{
+    const auto offset = AlignedSize(sizeof(SharedMemoryRingHeader))
+                      + (sequence % mHeader->slotsCount) * SlotStride(mHeader->slotSize);
+    return reinterpret_cast<SharedMemoryRingSlot*>(mMemory + offset);
+}
+
+SharedMemoryRingReader::~SharedMemoryRingReader()
+{
+    close();
+}
+
+bool SharedMemoryRingReader::open(const QString& name, bool fromOldest)
+{
+    if (isOpen()) close();
+
+    const auto shmName = ShmName(name);
+
+    const int fd = shm_open(shmName.constData(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        qWarning("[SharedMemoryRing] shm_open '%s' error: %s!",
+                 shmName.constData(), strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) not_eq 0
+     or static_cast<size_t>(info.st_size) < sizeof(SharedMemoryRingHeader))
+    {
+        qWarning("[SharedMemoryRing] Ring '%s' is not initialized!", shmName.constData());
+        ::close(fd);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        qWarning("[SharedMemoryRing] mmap '%s' error: %s!",
+                 shmName.constData(), strerror(errno));
+        return false;
+    }
+
+    auto header = static_cast<const SharedMemoryRingHeader*>(memory);
+    const bool valid = header->magic.load(std::memory_order_acquire) == RingMagic
+                   and header->version == RingVersion
+                   and header->slotsCount not_eq 0
+                   and RingSize(header->slotsCount, header->slotSize)
+                       <= static_cast<size_t>(info.st_size);
+
+    if (not valid)
+    {
+        qWarning("[SharedMemoryRing] Ring '%s' has unknown format!", shmName.constData());
+        munmap(memory, info.st_size);
+        return false;
+    }
+
+    mHeader = header;
+    mMemory = static_cast<const char*>(memory);
+    mMemorySize = info.st_size;
+    mLost = 0;
+    mAcquired = false;
+
+    const auto published = mHeader->published.load(std::memory_order_acquire);
+    mCursor = published;
+    if (fromOldest)
+    {
+        mCursor = (published >= mHeader->slotsCount) ? published - mHeader->slotsCount + 1 : 0;
+    }
+
+    return true;
+}
+
+void SharedMemoryRingReader::close()
+{
+    if (not isOpen()) return;
+
+    munmap(const_cast<char*>(mMemory), mMemorySize);
+
+    mHeader = nullptr;
+    mMemory = nullptr;
+    mMemorySize = 0;
+    mAcquired = false;
+}
+
+bool SharedMemoryRingReader::isOpen() const
+{
+    return mHeader not_eq nullptr;
+}
+
+quint32 SharedMemoryRingReader::slotSize() const
+{
+    return isOpen() ? mHeader->slotSize : 0;
+}
+
+quint64 SharedMemoryRingReader::sampleRate() const
+{
+    return isOpen() ? mHeader->sampleRate : 0;
+}
+
+quint64 SharedMemoryRingReader::frequency() const
+{
+    return isOpen() ? mHeader->frequency : 0;
+}
+
+quint64 SharedMemoryRingReader::lag() const
+{
+    if (not isOpen()) return 0;
+
+    const auto published = mHeader->published.load(std::memory_order_acquire);
+    return (published > mCursor) ? published - mCursor : 0;
+}
+
+quint64 SharedMemoryRingReader::lostBlocks() const
+{
+    return mLost;
+}
+
+SharedMemoryRingReader::ReadResult SharedMemoryRingReader::read(QByteArray& buffer, qint64* timestamp)
+{
+    const char* data = nullptr;
+    quint32 size = 0;
+
+    const auto result = acquire(&data, &size, timestamp);
+    if (result not_eq BlockRead) return result;
+
+    buffer.resize(size);
+    std::memcpy(buffer.data(), data, size);
+
+    if (not validate())
+    {
+        mAcquired = false;
+        skipOverwritten(mHeader->published.load(std::memory_order_acquire));
+        return Overrun;
+    }
+
+    release();
+    return BlockRead;
+}
+
+SharedMemoryRingReader::ReadResult SharedMemoryRingReader::acquire(const char** data, quint32* size,
+                                                                   qint64* timestamp)
+{
+    if (not isOpen()) return NoData;
+
+    const auto published = mHeader->published.load(std::memory_order_acquire);
+    if (mCursor >= published) return NoData;
+    if (skipOverwritten(published)) return Overrun;
+
+    auto source = slot(mCursor);
+    if (source->sequence.load(std::memory_order_acquire) not_eq mCursor + 1)
+    {
+        skipOverwritten(mHeader->published.load(std::memory_order_acquire));
+        return Overrun;
+    }
+
+    *data = reinterpret_cast<const char*>(source) + sizeof(SharedMemoryRingSlot);
+    *size = qMin(source->size, mHeader->slotSize);
+    if (timestamp) *timestamp = source->timestamp;
+
+    mAcquired = true;
+    return BlockRead;
+}
+
+bool SharedMemoryRingReader::validate() const
+{
+    if (not mAcquired) return false;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(mCursor)->sequence.load(std::memory_order_relaxed) == mCursor + 1;
+}
+
+void SharedMemoryRingReader::release()
+{
+    if (not mAcquired) return;
+
+    mAcquired = false;
+    ++mCursor;
+}
+
+SharedMemoryRingSlot* SharedMemoryRingReader::slot(quint64 sequence) const
+{
+    const auto offset = AlignedSize(sizeof(SharedMemoryRingHeader))
+                      + (sequence % mHeader->slotsCount) * SlotStride(mHeader->slotSize);
+    return reinterpret_cast<SharedMemoryRingSlot*>(const_cast<char*>(mMemory) + offset);
+}
+
+bool SharedMemoryRingReader::skipOverwritten(quint64 published)
+{
+    // Slot of the oldest block is the next one the writer will reuse
+    if (published - mCursor < mHeader->slotsCount) return false;
+
+    const auto oldest = published - mHeader->slotsCount + 1;
+    mLost += oldest - mCursor;
+    mCursor = oldest;
+    return true;
+}
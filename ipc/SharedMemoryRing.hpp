@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+
+// Memory layout (shared between processes, do not reorder):
+//   SharedMemoryRingHeader
+//   slotsCount * (SharedMemoryRingSlot + slotSize bytes of samples)
+//
+// One writer publishes blocks in order, every reader keeps its own cursor.
+// Slot sequence is "block number + 1" when the slot is complete and 0 while
+// the writer is rewriting it, so readers can detect torn and overwritten slots.
+
+struct SharedMemoryRingHeader
+{
+    std::atomic<quint32> magic;
+    quint32 version;
+    quint32 slotsCount;
+    quint32 slotSize;
+    quint64 sampleRate;
+    quint64 frequency;
+    std::atomic<quint64> published;
+};
+
+struct SharedMemoryRingSlot
+{
+    std::atomic<quint64> sequence;
+    quint32 size;
+    quint32 reserved;
+    qint64 timestamp; // msecs since epoch
+};
+
+class SharedMemoryRingWriter
+{
+public:
+    SharedMemoryRingWriter() = default;
+    ~SharedMemoryRingWriter();
+
+    SharedMemoryRingWriter(const SharedMemoryRingWriter&) = delete;
+    SharedMemoryRingWriter& operator=(const SharedMemoryRingWriter&) = delete;
+
+    bool create(const QString& name, quint32 slotsCount, quint32 slotSize,
+                quint64 sampleRate, quint64 frequency);
+    void destroy();
+
+    bool isOpen() const;
+    quint64 published() const;
+
+    bool publish(const char* data, quint32 size, qint64 timestamp);
+
+private:
+    SharedMemoryRingSlot* slot(quint64 sequence) const;
+
+private:
+    QString mName;
+    SharedMemoryRingHeader* mHeader = nullptr;
+    char* mMemory = nullptr;
+    size_t mMemorySize = 0;
+};
+
+class SharedMemoryRingReader
+{
+public:
+    enum ReadResult
+    {
+        BlockRead,
+        NoData,
+        Overrun
+    };
+
+public:
+    SharedMemoryRingReader() = default;
+    ~SharedMemoryRingReader();
+
+    SharedMemoryRingReader(const SharedMemoryRingReader&) = delete;
+    SharedMemoryRingReader& operator=(const SharedMemoryRingReader&) = delete;
+
+    // fromOldest = false starts reading from the next published block
+    bool open(const QString& name, bool fromOldest = false);
+    void close();
+
+    bool isOpen() const;
+    quint32 slotSize() const;
+    quint64 sampleRate() const;
+    quint64 frequency() const;
+
+    // Blocks published but not read yet by this reader
+    quint64 lag() const;
+    // Blocks overwritten before this reader got to them
+    quint64 lostBlocks() const;
+
+    // Copies next block into buffer. On Overrun the cursor is moved to the
+    // oldest block still available and lostBlocks() is increased.
+    ReadResult read(QByteArray& buffer, qint64* timestamp = nullptr);
+
+    // Zero-copy access: data points into the shared memory and stays valid
+    // only while validate() returns true for the same block.
+    ReadResult acquire(const char** data, quint32* size, qint64* timestamp = nullptr);
+    bool validate() const;
+    void release();
+
+private:
+    SharedMemoryRingSlot* slot(quint64 sequence) const;
+    bool skipOverwritten(quint64 published);
+
+private:
+    const SharedMemoryRingHeader* mHeader = nullptr;
+    const char* mMemory = nullptr;
+    size_t mMemorySize = 0;
+    quint64 mCursor = 0;
+    quint64 mLost = 0;
+    bool mAcquired = false;
+};
@@ -4,8 +4,10 @@
 #include <unistd.h>
 
 #include "Application.hpp"
+#include "stages/CircularRecorderStage.hpp"
 
 void systemSignalsHandler(int signalNumber);
+void dumpSignalHandler(int signalNumber);
 void checkPermissions();
 QString applicationPath();
 
@@ -23,6 +25,7 @@ int main(int argc, char** argv)
     signal(SIGINT , systemSignalsHandler);
     signal(SIGABRT, systemSignalsHandler);
     signal(SIGSEGV, systemSignalsHandler);
+    signal(SIGUSR1, dumpSignalHandler);
 
 #ifndef QT_DEBUG
     checkPermissions();
@@ -49,6 +52,10 @@ void systemSignalsHandler(int signalNumber)
     Application::exit(exitCode);
 }
 
+void dumpSignalHandler(int )
+{
+    CircularRecorderStage::requestDump();
+}
 
 void checkPermissions()
 {
@@ -0,0 +1,32 @@
+#include "AbstractPipelineStage.hpp"
+
+AbstractPipelineStage::AbstractPipelineStage(const QString& name)
+    : mName(name)
+{
+
+}
+
+const QString& AbstractPipelineStage::name() const
+{
+    return mName;
+}
+
+const PipelineStageStatistics& AbstractPipelineStage::statistics() const
+{
+    return mStatistics;
+}
+
+PipelineStageStatistics& AbstractPipelineStage::statistics()
+{
+    return mStatistics;
+}
+
+quint64 AbstractPipelineStage::errorsCount() const
+{
+    return mStatistics.errors.load();
+}
+
+void AbstractPipelineStage::reportError()
+{
+    mStatistics.errors.fetch_add(1);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+
+#include "SampleBlock.hpp"
+
+struct PipelineStageStatistics
+{
+    std::atomic<quint64> blocks = 0;
+    std::atomic<quint64> bytes = 0;
+    std::atomic<quint64> busyNanoseconds = 0;
+    std::atomic<quint64> maxQueueDepth = 0;
+    std::atomic<quint64> errors = 0;
+};
+
+class AbstractPipelineStage
+{
+public:
+    explicit AbstractPipelineStage(const QString& name);
+    virtual ~AbstractPipelineStage() = default;
+
+    const QString& name() const;
+
+    // Called from pool workers, never concurrently for the same stage and
+    // always in block order. Returns the block for downstream stages or
+    // nullptr to stop propagation (sinks usually return the input block).
+    virtual SampleBlockPtr process(const SampleBlockPtr& block) = 0;
+
+    // Called once after the last block has passed the whole pipeline
+    virtual void finish() {}
+
+    const PipelineStageStatistics& statistics() const;
+    PipelineStageStatistics& statistics();
+    quint64 errorsCount() const;
+
+protected:
+    void reportError();
+
+private:
+    QString mName;
+    PipelineStageStatistics mStatistics;
+};
@@ -0,0 +1,193 @@
+#include <chrono>
+
+#include "AbstractPipelineStage.hpp"
+#include "Pipeline.hpp"
+
+#include "tracing/Tracer.hpp"
+
+inline const int DrainBatchSize = 16;
+
+Pipeline::Pipeline(quint32 capacity, WorkStealingThreadPool& pool)
+    : mPool(pool)
+    , mCapacity(capacity ? capacity : 1)
+{
+
+}
+
+Pipeline::~Pipeline()
+{
+    finish();
+}
+
+int Pipeline::addStage(const std::shared_ptr<AbstractPipelineStage>& stage, int upstream)
+{
+    auto node = new Node;
+    node->stage = stage;
+    node->traceName = Tracer::instance().intern(stage->name());
+
+    if (upstream >= 0 and upstream < static_cast<int>(mNodes.size()))
+    {
+        mNodes[upstream]->downstream.push_back(node);
+    }
+    else mRoots.push_back(node);
+
+    mNodes.emplace_back(node);
+    return mNodes.size() - 1;
+}
+
+void Pipeline::push(const SampleBlockPtr& block)
+{
+    {
+        std::unique_lock<std::mutex> lock(mPendingMutex);
+        if (mPending >= mCapacity)
+        {
+            ++mStalledPushes;
+            mPendingChanged.wait(lock, [this]() { return mPending < mCapacity; });
+        }
+
+        mPending += mRoots.size();
+        ++mPushedBlocks;
+        mFinished = false;
+    }
+
+    for (auto node : mRoots) deliver(node, block);
+}
+
+void Pipeline::finish()
+{
+    {
+        std::unique_lock<std::mutex> lock(mPendingMutex);
+        mPendingChanged.wait(lock, [this]() { return mPending == 0 and mActiveDrains == 0; });
+
+        if (mFinished) return;
+        mFinished = true;
+    }
+
+    // Nodes are stored upstream first
+    for (auto& node : mNodes) node->stage->finish();
+}
+
+quint64 Pipeline::pushedBlocks() const
+{
+    return mPushedBlocks;
+}
+
+quint64 Pipeline::stalledPushes() const
+{
+    return mStalledPushes;
+}
+
+void Pipeline::printStatistics() const
+{
+    qInfo("[Pipeline] %llu blocks pushed, %llu pushes stalled by back-pressure.",
+          mPushedBlocks, mStalledPushes);
+
+    for (auto& node : mNodes)
+    {
+        const auto& statistics = node->stage->statistics();
+        const double busySeconds = statistics.busyNanoseconds.load() / 1e9;
+        const double megabytes = statistics.bytes.load() / 1e6;
+
+        qInfo("[Pipeline] %s: %llu blocks | %.1f MB | busy %.3f s | %.1f MB/s | "
+              "max queue %llu | errors %llu",
+              qPrintable(node->stage->name()),
+              statistics.blocks.load(),
+              megabytes,
+              busySeconds,
+              busySeconds > 0 ? megabytes / busySeconds : 0.0,
+              statistics.maxQueueDepth.load(),
+              statistics.errors.load());
+    }
+}
+
+void Pipeline::deliver(Node* node, const SampleBlockPtr& block)
+{
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->queue.push_back(block);
+
+        auto& maxQueueDepth = node->stage->statistics().maxQueueDepth;
+        if (node->queue.size() > maxQueueDepth.load(std::memory_order_relaxed))
+        {
+            maxQueueDepth.store(node->queue.size(), std::memory_order_relaxed);
+        }
+
+        schedule = not node->scheduled;
+        node->scheduled = true;
+    }
+
+    if (schedule)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mPendingMutex);
+            ++mActiveDrains;
+        }
+        mPool.submit([this, node]() { drain(node); });
+    }
+}
+
+void Pipeline::drain(Node* node)
+{
+    for (int i = 0; i < DrainBatchSize; ++i)
+    {
+        SampleBlockPtr block;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            if (node->queue.empty()) node->scheduled = false;
+            else
+            {
+                block = std::move(node->queue.front());
+                node->queue.pop_front();
+            }
+        }
+
+        if (not block)
+        {
+            // Notify under lock: finish() may destroy the pipeline right after
+            std::lock_guard<std::mutex> lock(mPendingMutex);
+            --mActiveDrains;
+            mPendingChanged.notify_all();
+            return;
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        SampleBlockPtr output;
+        {
+            TraceSpan span(node->traceName, "pipeline");
+            output = node->stage->process(block);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        auto& statistics = node->stage->statistics();
+        statistics.blocks.fetch_add(1, std::memory_order_relaxed);
+        statistics.bytes.fetch_add(block->data.size(), std::memory_order_relaxed);
+        statistics.busyNanoseconds.fetch_add(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(),
+                    std::memory_order_relaxed);
+
+        if (output and not node->downstream.empty())
+        {
+            addPending(node->downstream.size());
+            for (auto next : node->downstream) deliver(next, output);
+        }
+
+        completePending();
+    }
+
+    // Still scheduled: let other stages run before the rest of the queue
+    mPool.yield([this, node]() { drain(node); });
+}
+
+void Pipeline::addPending(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    mPending += count;
+}
+
+void Pipeline::completePending()
+{
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    --mPending;
+    mPendingChanged.notify_all();
+}
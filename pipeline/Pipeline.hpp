@@ -0,0 +1,77 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <condition_variable>
+
+#include "SampleBlock.hpp"
+#include "WorkStealingThreadPool.hpp"
+
+class AbstractPipelineStage;
+
+// Stage graph fed by a source thread. Every stage runs on the pool as an
+// actor: blocks are queued per stage and drained by one task at a time, so
+// stages are single-threaded and see blocks in order while independent
+// stages run in parallel. Queues are bounded by the pipeline capacity:
+// push() blocks the source while that many deliveries are pending.
+class Pipeline
+{
+public:
+    static const int Source = -1;
+
+public:
+    explicit Pipeline(quint32 capacity,
+                      WorkStealingThreadPool& pool = WorkStealingThreadPool::globalInstance());
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Returns stage id to be used as upstream for the next stages
+    int addStage(const std::shared_ptr<AbstractPipelineStage>& stage, int upstream = Source);
+
+    void push(const SampleBlockPtr& block);
+
+    // Waits for all pushed blocks and calls finish() of every stage
+    void finish();
+
+    quint64 pushedBlocks() const;
+    quint64 stalledPushes() const;
+
+    void printStatistics() const;
+
+private:
+    struct Node
+    {
+        std::shared_ptr<AbstractPipelineStage> stage;
+        std::vector<Node*> downstream;
+        const char* traceName = nullptr;
+
+        std::mutex mutex;
+        std::deque<SampleBlockPtr> queue;
+        bool scheduled = false;
+    };
+
+    void deliver(Node* node, const SampleBlockPtr& block);
+    void drain(Node* node);
+    void addPending(size_t count);
+    void completePending();
+
+private:
+    WorkStealingThreadPool& mPool;
+    const quint32 mCapacity;
+
+    std::vector<std::unique_ptr<Node>> mNodes;
+    std::vector<Node*> mRoots;
+
+    std::mutex mPendingMutex;
+    std::condition_variable mPendingChanged;
+    quint64 mPending = 0;
+    quint64 mActiveDrains = 0;
+
+    quint64 mPushedBlocks = 0;
+    quint64 mStalledPushes = 0;
+    bool mFinished = false;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QByteArray>
+
+#include <memory>
+
+#include "dsp/BlockStatistics.hpp"
+
+inline const quint16 SampleSize = sizeof(quint16) * 2;
+
+struct SampleBlock
+{
+    quint64 number = 0;     // block number since the mission start
+    qint64 timestamp = 0;   // msecs since epoch
+    bool discontinuity = false; // samples lost right before this block
+    quint16 gain = 0;           // RX gain in dB the block was captured at
+    bool gainChanged = false;   // first block captured after a gain change
+    bool hasStatistics = false; // statistics already computed by the source
+    BlockStatistics statistics;
+    QByteArray data;        // interleaved I16 IQ samples
+};
+
+// Blocks are shared between stages and never modified after push,
+// filters produce a new block instead
+using SampleBlockPtr = std::shared_ptr<const SampleBlock>;
@@ -0,0 +1,95 @@
+#include "SampleBlockPool.hpp"
+
+SampleBlockPool::SampleBlockPool(quint32 blocksCount, quint32 blockSize)
+    : mBlocksCount(blocksCount)
+    , mBlockSize(blockSize)
+    , mState(std::make_shared<State>())
+{
+    mState->free.reserve(blocksCount);
+    for (quint32 i = 0; i < blocksCount; ++i)
+    {
+        auto block = new SampleBlock;
+        block->data = QByteArray(blockSize, Qt::Uninitialized);
+        mState->free.push_back(block);
+    }
+}
+
+SampleBlockPool::~SampleBlockPool()
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    mState->closed = true;
+
+    for (auto block : mState->free) delete block;
+    mState->free.clear();
+}
+
+std::shared_ptr<SampleBlock> SampleBlockPool::acquire()
+{
+    mAcquired.fetch_add(1, std::memory_order_relaxed);
+
+    SampleBlock* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mState->mutex);
+        if (not mState->free.empty())
+        {
+            block = mState->free.back();
+            mState->free.pop_back();
+
+            ++mState->inUse;
+            mState->maxInUse = qMax(mState->maxInUse, mState->inUse);
+        }
+    }
+
+    if (not block)
+    {
+        mExhausted.fetch_add(1, std::memory_order_relaxed);
+
+        auto overflow = std::make_shared<SampleBlock>();
+        overflow->data = QByteArray(mBlockSize, Qt::Uninitialized);
+        return overflow;
+    }
+
+    // Keep the buffer, reset the metadata of the previous use
+    auto data = std::move(block->data);
+    *block = SampleBlock();
+    block->data = std::move(data);
+
+    auto state = mState;
+    return std::shared_ptr<SampleBlock>(block, [state](SampleBlock* block) { release(state, block); });
+}
+
+quint32 SampleBlockPool::blocksCount() const
+{
+    return mBlocksCount;
+}
+
+quint64 SampleBlockPool::acquiredCount() const
+{
+    return mAcquired.load();
+}
+
+quint64 SampleBlockPool::exhaustedCount() const
+{
+    return mExhausted.load();
+}
+
+quint32 SampleBlockPool::maxInUse() const
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return mState->maxInUse;
+}
+
+void SampleBlockPool::printStatistics() const
+{
+    qInfo("[SampleBlockPool] %u blocks of %u bytes | %llu acquired | %llu exhausted | max in use %u",
+          mBlocksCount, mBlockSize, acquiredCount(), exhaustedCount(), maxInUse());
+}
+
+void SampleBlockPool::release(const std::shared_ptr<State>& state, SampleBlock* block)
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    --state->inUse;
+
+    if (state->closed) delete block;
+    else state->free.push_back(block);
+}
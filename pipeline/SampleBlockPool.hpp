@@ -0,0 +1,56 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "SampleBlock.hpp"
+
+// Fixed set of preallocated blocks handed out as shared pointers: when the
+// last consumer drops its reference the block goes back to the pool with its
+// buffer, so steady state capture allocates no sample memory. If every block
+// is held, acquire() does not wait (the source is real time) but allocates
+// a one-off block and counts the exhaustion. A consumer keeping a copy of
+// block->data shares the buffer: the next writer into it detaches (copies).
+class SampleBlockPool
+{
+public:
+    SampleBlockPool(quint32 blocksCount, quint32 blockSize);
+    ~SampleBlockPool();
+
+    SampleBlockPool(const SampleBlockPool&) = delete;
+    SampleBlockPool& operator=(const SampleBlockPool&) = delete;
+
+    // Block with blockSize bytes of uninitialized data and default metadata
+    std::shared_ptr<SampleBlock> acquire();
+
+    quint32 blocksCount() const;
+    quint64 acquiredCount() const;
+    quint64 exhaustedCount() const;
+    quint32 maxInUse() const;
+
+    void printStatistics() const;
+
+private:
+    // Shared with the deleters of handed out blocks, so blocks released
+    // after the pool is gone are freed instead of returned
+    struct State
+    {
+        std::mutex mutex;
+        std::vector<SampleBlock*> free;
+        bool closed = false;
+        quint32 inUse = 0;
+        quint32 maxInUse = 0;
+    };
+
+    static void release(const std::shared_ptr<State>& state, SampleBlock* block);
+
+private:
+    const quint32 mBlocksCount;
+    const quint32 mBlockSize;
+    std::shared_ptr<State> mState;
+
+    std::atomic<quint64> mAcquired = 0;
+    std::atomic<quint64> mExhausted = 0;
+};
@@ -0,0 +1,173 @@
+#include <algorithm>
+
+#include "WorkStealingThreadPool.hpp"
+
+#include "tracing/Tracer.hpp"
+
+thread_local WorkStealingThreadPool* WorkStealingThreadPool::sCurrentPool = nullptr;
+thread_local unsigned WorkStealingThreadPool::sCurrentWorker = 0;
+
+WorkStealingThreadPool& WorkStealingThreadPool::globalInstance()
+{
+    static WorkStealingThreadPool instance;
+    return instance;
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(unsigned threadsCount)
+{
+    if (threadsCount == 0) threadsCount = std::thread::hardware_concurrency();
+    if (threadsCount == 0) threadsCount = 1;
+
+    for (unsigned i = 0; i < threadsCount; ++i)
+    {
+        mWorkers.emplace_back(new Worker);
+    }
+
+    for (unsigned i = 0; i < threadsCount; ++i)
+    {
+        mWorkers[i]->thread = std::thread(&WorkStealingThreadPool::workerRoutine, this, i);
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStopFlag.store(true);
+    }
+    mWakeUp.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+unsigned WorkStealingThreadPool::threadsCount() const
+{
+    return mWorkers.size();
+}
+
+void WorkStealingThreadPool::submit(Task task)
+{
+    push(std::move(task), true);
+}
+
+void WorkStealingThreadPool::yield(Task task)
+{
+    push(std::move(task), false);
+}
+
+void WorkStealingThreadPool::push(Task task, bool newest)
+{
+    // Workers keep their own tasks local, external threads spread them round-robin
+    const unsigned index = (sCurrentPool == this)
+                         ? sCurrentWorker
+                         : mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mPendingTasks.fetch_add(1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+        // The owner pops the back, so the front runs after everything else
+        if (newest) mWorkers[index]->tasks.push_back(std::move(task));
+        else mWorkers[index]->tasks.push_front(std::move(task));
+    }
+    mWakeUp.notify_one();
+}
+
+void WorkStealingThreadPool::parallelFor(size_t count, size_t grain, const RangeTask& body)
+{
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    struct State
+    {
+        std::atomic<size_t> nextChunk = 0;
+        size_t doneChunks = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    const size_t chunks = (count + grain - 1) / grain;
+    auto state = std::make_shared<State>();
+
+    // body is referenced only while a chunk is taken, and this call does not
+    // return before every taken chunk is done, so late helpers never touch it
+    auto work = [state, chunks, count, grain, &body]()
+    {
+        size_t chunk;
+        while ((chunk = state->nextChunk.fetch_add(1)) < chunks)
+        {
+            body(chunk * grain, std::min(count, (chunk + 1) * grain));
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (++state->doneChunks == chunks) state->finished.notify_all();
+        }
+    };
+
+    const size_t helpers = std::min<size_t>(mWorkers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; ++i) submit(work);
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->doneChunks == chunks; });
+}
+
+void WorkStealingThreadPool::workerRoutine(unsigned index)
+{
+    sCurrentPool = this;
+    sCurrentWorker = index;
+    Tracer::instance().setThreadName("pool worker");
+
+    Task task;
+    while (true)
+    {
+        if (popTask(index, task) or stealTask(index, task))
+        {
+            mPendingTasks.fetch_sub(1);
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this]() { return mPendingTasks.load() > 0 or mStopFlag.load(); });
+
+        if (mStopFlag.load() and mPendingTasks.load() == 0) break;
+    }
+}
+
+bool WorkStealingThreadPool::popTask(unsigned index, Task& task)
+{
+    auto& worker = *mWorkers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.tasks.empty()) return false;
+
+    // Newest first keeps the working set in cache
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingThreadPool::stealTask(unsigned thief, Task& task)
+{
+    const unsigned count = mWorkers.size();
+    for (unsigned i = 1; i < count; ++i)
+    {
+        auto& victim = *mWorkers[(thief + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tasks.empty()) continue;
+
+        // Oldest first, it is the largest piece of the victim's work
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+class WorkStealingThreadPool
+{
+public:
+    using Task = std::function<void()>;
+    using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+public:
+    static WorkStealingThreadPool& globalInstance();
+
+    // threadsCount = 0 means one worker per hardware thread
+    explicit WorkStealingThreadPool(unsigned threadsCount = 0);
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    unsigned threadsCount() const;
+
+    void submit(Task task);
+
+    // Like submit(), but a worker queues the task behind all of its pending
+    // tasks instead of running it next
+    void yield(Task task);
+
+    // Splits [0, count) into chunks of grain items and blocks until all are done.
+    // The calling thread takes chunks too, so it is safe to call from a worker.
+    void parallelFor(size_t count, size_t grain, const RangeTask& body);
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void push(Task task, bool newest);
+    void workerRoutine(unsigned index);
+    bool popTask(unsigned index, Task& task);
+    bool stealTask(unsigned thief, Task& task);
+
+private:
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+
+    std::atomic<size_t> mPendingTasks = 0;
+    std::atomic<unsigned> mNextWorker = 0;
+    std::atomic_bool mStopFlag = false;
+
+    static thread_local WorkStealingThreadPool* sCurrentPool;
+    static thread_local unsigned sCurrentWorker;
+};
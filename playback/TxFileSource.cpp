@@ -0,0 +1,135 @@
+#include <cmath>
+#include <algorithm>
+
+#include "dsp/RationalResampler.hpp"
+#include "pipeline/SampleBlock.hpp"
+#include "TxFileSource.hpp"
+
+inline const unsigned MaxResamplingFactor = 1024;
+
+TxFileSource::TxFileSource(const QString& fileName, SampleFormat format, quint64 fileSampleRate,
+                           quint64 outputSampleRate, double gainDb)
+    : mFile(fileName)
+    , mFormat(format)
+    , mFileSampleRate(fileSampleRate ? fileSampleRate : outputSampleRate)
+    , mOutputSampleRate(outputSampleRate)
+    , mGain(std::pow(10.0, gainDb / 20.0))
+{
+
+}
+
+TxFileSource::~TxFileSource() = default;
+
+bool TxFileSource::open()
+{
+    if (not mFile.open(QIODevice::ReadOnly))
+    {
+        qWarning("[TxFileSource] File open error: %s!", qPrintable(mFile.errorString()));
+        return false;
+    }
+
+    const auto sampleSize = SampleFormatSize(mFormat);
+    if (mFile.size() < qint64(sampleSize))
+    {
+        qWarning("[TxFileSource] File '%s' has no samples!", qPrintable(mFile.fileName()));
+        return false;
+    }
+
+    if (mFile.size() % sampleSize)
+    {
+        qWarning("[TxFileSource] File size is not a multiple of %s sample, tail is ignored!",
+                 SampleFormatName(mFormat));
+    }
+
+    if (mFileSampleRate not_eq mOutputSampleRate)
+    {
+        unsigned interpolation = 1;
+        unsigned decimation = 1;
+        if (not RationalResampler::ratio(mFileSampleRate, mOutputSampleRate, MaxResamplingFactor,
+                                         interpolation, decimation))
+        {
+            qWarning("[TxFileSource] Unsupported resampling %llu -> %llu Hz!",
+                     mFileSampleRate, mOutputSampleRate);
+            return false;
+        }
+
+        mResampler = std::make_unique<RationalResampler>(interpolation, decimation);
+
+        // Keep output chunks close to TxChunkSamples
+        mReadSamples = std::max<size_t>(1, size_t(TxChunkSamples) * decimation / interpolation);
+
+        qInfo("[TxFileSource] Resampling %llu -> %llu Hz as %u / %u.",
+              mFileSampleRate, mOutputSampleRate, interpolation, decimation);
+    }
+
+    mPassthrough = not mResampler
+               and mFormat == SampleFormat::I16
+               and mGain == 1.0f;
+
+    mRaw.resize(mReadSamples * sampleSize);
+    return true;
+}
+
+bool TxFileSource::rewind()
+{
+    if (not mFile.seek(0))
+    {
+        qWarning("[TxFileSource] File seek error: %s!", qPrintable(mFile.errorString()));
+        mFailed = true;
+        return false;
+    }
+    else return true;
+}
+
+bool TxFileSource::read(QByteArray& output)
+{
+    const auto sampleSize = SampleFormatSize(mFormat);
+
+    if (mPassthrough)
+    {
+        output.resize(mReadSamples * SampleSize);
+        const auto bytes = mFile.read(output.data(), output.size());
+        if (bytes < 0)
+        {
+            qWarning("[TxFileSource] File read error: %s!", qPrintable(mFile.errorString()));
+            mFailed = true;
+            return false;
+        }
+
+        output.resize(bytes / SampleSize * SampleSize);
+        return not output.isEmpty();
+    }
+
+    const auto bytes = mFile.read(mRaw.data(), mRaw.size());
+    if (bytes < 0)
+    {
+        qWarning("[TxFileSource] File read error: %s!", qPrintable(mFile.errorString()));
+        mFailed = true;
+        return false;
+    }
+
+    const size_t count = bytes / sampleSize;
+    if (count == 0) return false;
+
+    mSamples.resize(count * 2);
+    ConvertToFloat(mRaw.constData(), mFormat, count, mSamples.data());
+
+    const float* samples = mSamples.data();
+    size_t produced = count;
+
+    if (mResampler)
+    {
+        mResampled.clear();
+        produced = mResampler->process(mSamples.data(), count, mResampled);
+        samples = mResampled.data();
+    }
+
+    output.resize(produced * SampleSize);
+    ConvertToI16(samples, produced, mGain, reinterpret_cast<qint16*>(output.data()));
+    return true;
+}
+
+bool TxFileSource::failed() const
+{
+    return mFailed;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#include <memory>
+#include <vector>
+
+#include "dsp/SampleConversion.hpp"
+
+class RationalResampler;
+
+// Output samples per read(), also sizes the TX stream FIFO
+inline const quint32 TxChunkSamples = 65536;
+
+// Streams a TX file chunk by chunk as I16 at the mission sample rate:
+// converts the sample format, resamples from the file rate and applies the
+// digital gain. Plain I16 at the mission rate without gain is read as is.
+class TxFileSource
+{
+public:
+    TxFileSource(const QString& fileName, SampleFormat format, quint64 fileSampleRate,
+                 quint64 outputSampleRate, double gainDb);
+    ~TxFileSource();
+
+    bool open();
+
+    // Starts the next pass over the file, resampler state is kept so
+    // repeated passes play as one continuous signal
+    bool rewind();
+
+    // Replaces output with the next chunk, may be empty while the resampler
+    // collects input. Returns false at the end of the file or on error.
+    bool read(QByteArray& output);
+
+    bool failed() const;
+
+private:
+    QFile mFile;
+    SampleFormat mFormat;
+    quint64 mFileSampleRate;
+    quint64 mOutputSampleRate;
+    float mGain;
+
+    std::unique_ptr<RationalResampler> mResampler;
+    size_t mReadSamples = TxChunkSamples;
+    bool mPassthrough = false;
+    bool mFailed = false;
+
+    QByteArray mRaw;
+    std::vector<float> mSamples;
+    std::vector<float> mResampled;
+};
@@ -0,0 +1,497 @@
+#include <cmath>
+#include <algorithm>
+
+#include "RecordingIndex.hpp"
+
+inline const quint32 IndexMagic = 0x4C4D5349; // "LMSI"
+inline const quint32 OverviewMagic = 0x4C4D534F; // "LMSO"
+inline const quint32 IndexVersion = 1;
+inline const char* IndexFileName = "index.bin";
+inline const char* OverviewFileName = "overview.bin";
+inline const int PyramidChunkNodes = 64 * 1024; // even: pairs never span two chunks
+
+bool RecordingIndexWriter::open(const QString& directory, quint64 sampleRate, quint64 frequency,
+                                qint64 startTimestamp, SampleFormat format, quint32 flags)
+{
+    mDirectory = directory;
+    mOffset = 0;
+
+    mIndex.setFileName(directory + "/" + IndexFileName);
+    if (not mIndex.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[RecordingIndex] Index open error: %s!", qPrintable(mIndex.errorString()));
+        return false;
+    }
+
+    RecordingIndexHeader header;
+    header.magic = IndexMagic;
+    header.version = IndexVersion;
+    header.sampleRate = sampleRate;
+    header.frequency = frequency;
+    header.startTimestamp = startTimestamp;
+    header.sampleFormat = static_cast<quint32>(format);
+    header.flags = flags;
+
+    if (mIndex.write(reinterpret_cast<const char*>(&header), sizeof(header)) not_eq sizeof(header))
+    {
+        qWarning("[RecordingIndex] Index write error: %s!", qPrintable(mIndex.errorString()));
+        mIndex.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool RecordingIndexWriter::append(RecordingIndexEntry entry, bool flush)
+{
+    if (not mIndex.isOpen()) return false;
+
+    entry.offset = mOffset;
+    mOffset += entry.size;
+
+    if (mIndex.write(reinterpret_cast<const char*>(&entry), sizeof(entry)) not_eq sizeof(entry)
+     or (flush and not mIndex.flush()))
+    {
+        qWarning("[RecordingIndex] Index write error: %s!", qPrintable(mIndex.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+// Pairs of the previous level nodes starting at node first. A previous level
+// node covers blocksPerNode blocks, only the last one of the level may cover less.
+static void MergePairs(const QVector<RecordingOverviewNode>& previous, quint64 first,
+                       quint64 blocksPerNode, quint64 blocksCount, QVector<RecordingOverviewNode>& level)
+{
+    level.clear();
+    for (int i = 0; i < previous.count(); i += 2)
+    {
+        auto node = previous.at(i);
+
+        if (i + 1 < previous.count())
+        {
+            const auto& right = previous.at(i + 1);
+            const quint64 blocks = blocksPerNode;
+            const quint64 rightBlocks = qMin(blocksPerNode, blocksCount - (first + i + 1) * blocksPerNode);
+
+            node.meanPower = (node.meanPower * blocks + right.meanPower * rightBlocks)
+                           / (blocks + rightBlocks);
+            node.peakPower = qMax(node.peakPower, right.peakPower);
+        }
+
+        level.append(node);
+    }
+}
+
+bool RecordingIndexWriter::finish()
+{
+    if (not mIndex.isOpen()) return false;
+    mIndex.close();
+
+    // Built from index.bin on disk level by level in chunks, so neither the
+    // recording nor this pass keeps the entries of a long capture in memory
+    QFile index(mDirectory + "/" + IndexFileName);
+    if (not index.open(QIODevice::ReadOnly) or not index.seek(sizeof(RecordingIndexHeader)))
+    {
+        qWarning("[RecordingIndex] Index open error: %s!", qPrintable(index.errorString()));
+        return false;
+    }
+
+    QFile overview(mDirectory + "/" + OverviewFileName);
+    if (not overview.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        qWarning("[RecordingIndex] Overview open error: %s!", qPrintable(overview.errorString()));
+        return false;
+    }
+
+    // A partially written last entry is dropped, as load() does
+    const quint64 entriesCount = (index.size() - sizeof(RecordingIndexHeader)) / sizeof(RecordingIndexEntry);
+
+    quint32 levelsCount = 0;
+    for (quint64 size = entriesCount; size > 1; size = (size + 1) / 2) ++levelsCount;
+
+    RecordingOverviewHeader header;
+    header.magic = OverviewMagic;
+    header.version = IndexVersion;
+    header.entriesCount = entriesCount;
+    header.levelsCount = levelsCount;
+    header.reserved = 0;
+
+    bool result = overview.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+
+    QVector<RecordingIndexEntry> entries;
+    QVector<RecordingOverviewNode> previous;
+    QVector<RecordingOverviewNode> level;
+    quint64 previousCount = entriesCount;
+    quint64 blocksPerNode = 1;
+    qint64 previousOffset = 0;
+    qint64 levelOffset = sizeof(header);
+
+    for (quint32 l = 0; result and l < levelsCount; ++l)
+    {
+        for (quint64 first = 0; result and first < previousCount; first += PyramidChunkNodes)
+        {
+            const int count = qMin<quint64>(PyramidChunkNodes, previousCount - first);
+            previous.resize(count);
+
+            if (l == 0)
+            {
+                entries.resize(count);
+                const qint64 size = count * sizeof(RecordingIndexEntry);
+                result = index.read(reinterpret_cast<char*>(entries.data()), size) == size;
+
+                for (int i = 0; i < count; ++i) previous[i] = { entries.at(i).meanPower, entries.at(i).peakPower };
+            }
+            else
+            {
+                const qint64 size = count * sizeof(RecordingOverviewNode);
+                result = overview.seek(previousOffset + first * sizeof(RecordingOverviewNode))
+                     and overview.read(reinterpret_cast<char*>(previous.data()), size) == size;
+            }
+
+            MergePairs(previous, first, blocksPerNode, entriesCount, level);
+
+            const qint64 size = level.count() * sizeof(RecordingOverviewNode);
+            result = result
+                 and overview.seek(levelOffset + first / 2 * sizeof(RecordingOverviewNode))
+                 and overview.write(reinterpret_cast<const char*>(level.constData()), size) == size;
+        }
+
+        previousOffset = levelOffset;
+        previousCount = (previousCount + 1) / 2;
+        levelOffset += previousCount * sizeof(RecordingOverviewNode);
+        blocksPerNode *= 2;
+    }
+
+    if (not result)
+    {
+        qWarning("[RecordingIndex] Overview write error: %s!", qPrintable(overview.errorString()));
+    }
+
+    return result;
+}
+
+void RecordingIndexWriter::discard()
+{
+    mIndex.close();
+    QFile::remove(mDirectory + "/" + IndexFileName);
+    QFile::remove(mDirectory + "/" + OverviewFileName);
+}
+
+quint64 RecordingIndexWriter::recordedBytes() const
+{
+    return mOffset;
+}
+
+bool RecordingIndex::load(const QString& directory)
+{
+    mDirectory = directory;
+    mEntries.clear();
+    mLevels.clear();
+
+    QFile index(directory + "/" + IndexFileName);
+    if (not index.open(QIODevice::ReadOnly))
+    {
+        qWarning("[RecordingIndex] Index open error: %s!", qPrintable(index.errorString()));
+        return false;
+    }
+
+    if (index.read(reinterpret_cast<char*>(&mHeader), sizeof(mHeader)) not_eq sizeof(mHeader)
+     or mHeader.magic not_eq IndexMagic
+     or mHeader.version not_eq IndexVersion)
+    {
+        qWarning("[RecordingIndex] '%s' is not a recording index!", qPrintable(index.fileName()));
+        return false;
+    }
+
+    // A partially written last entry of a killed capture is dropped
+    const auto data = index.readAll();
+    mEntries.resize(data.size() / sizeof(RecordingIndexEntry));
+    std::copy(data.constData(), data.constData() + mEntries.count() * sizeof(RecordingIndexEntry),
+              reinterpret_cast<char*>(mEntries.data()));
+
+    if (not loadOverview()) mLevels = buildPyramid(mEntries);
+
+    return true;
+}
+
+const QString& RecordingIndex::directory() const
+{
+    return mDirectory;
+}
+
+const RecordingIndexHeader& RecordingIndex::header() const
+{
+    return mHeader;
+}
+
+const QVector<RecordingIndexEntry>& RecordingIndex::entries() const
+{
+    return mEntries;
+}
+
+int RecordingIndex::levelsCount() const
+{
+    return mLevels.count() + 1;
+}
+
+RecordingRange RecordingIndex::findTimeRange(qint64 fromMs, qint64 toMs) const
+{
+    RecordingRange range;
+    if (mEntries.isEmpty() or toMs < fromMs) return range;
+
+    const auto byTimestamp = [](qint64 timestamp, const RecordingIndexEntry& entry)
+    {
+        return timestamp < entry.timestamp;
+    };
+
+    // Block i lasts from its timestamp to the timestamp of block i + 1
+    const auto first = std::upper_bound(mEntries.begin(), mEntries.end(),
+                                        mHeader.startTimestamp + fromMs, byTimestamp);
+    const auto last = std::upper_bound(mEntries.begin(), mEntries.end(),
+                                       mHeader.startTimestamp + toMs, byTimestamp);
+
+    range.first = qMax<int>(0, first - mEntries.begin() - 1);
+    range.last = last - mEntries.begin();
+    return range;
+}
+
+QVector<RecordingRange> RecordingIndex::findEnergetic(double thresholdDbfs) const
+{
+    QVector<RecordingRange> ranges;
+    if (mEntries.isEmpty()) return ranges;
+
+    const float threshold = std::pow(10.0, thresholdDbfs / 10);
+    collectEnergetic(levelsCount() - 1, 0, threshold, ranges);
+    return ranges;
+}
+
+RecordingOverviewNode RecordingIndex::summary(const RecordingRange& range) const
+{
+    double powerSum = 0;
+    quint64 blocks = 0;
+    float peak = 0;
+
+    if (not mEntries.isEmpty() and not range.isEmpty())
+    {
+        summarize(levelsCount() - 1, 0, range, powerSum, blocks, peak);
+    }
+
+    return { blocks ? float(powerSum / blocks) : 0.0f, peak };
+}
+
+bool RecordingIndex::extract(const RecordingRange& range, const QString& output) const
+{
+    QFile target(output);
+    if (not target.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[RecordingIndex] Output open error: %s!", qPrintable(target.errorString()));
+        return false;
+    }
+
+    // Converted captures keep every block in one samples file at entry.offset
+    QFile samples;
+    if (mHeader.flags & IndexSamplesFile)
+    {
+        samples.setFileName(mDirectory + "/" + samplesFileName(static_cast<SampleFormat>(mHeader.sampleFormat),
+                                                               mHeader.flags & IndexCompressed));
+        if (not samples.open(QIODevice::ReadOnly))
+        {
+            qWarning("[RecordingIndex] Samples open error: %s!", qPrintable(samples.errorString()));
+            return false;
+        }
+    }
+
+    for (int i = range.first; i < range.last and i < mEntries.count(); ++i)
+    {
+        const auto& entry = mEntries.at(i);
+        QByteArray data;
+
+        if (samples.isOpen())
+        {
+            if (samples.seek(entry.offset)) data = samples.read(entry.size);
+            if (data.size() not_eq qint64(entry.size))
+            {
+                qWarning("[RecordingIndex] Samples read error: %s!", qPrintable(samples.errorString()));
+                return false;
+            }
+
+            if (entry.flags & IndexEntryCompressed)
+            {
+                data = qUncompress(data);
+                if (data.isEmpty())
+                {
+                    qWarning("[RecordingIndex] Block %llu is corrupted!", entry.blockNumber);
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            QFile block(mDirectory + "/" + blockFileName(entry.blockNumber));
+            if (not block.open(QIODevice::ReadOnly))
+            {
+                qWarning("[RecordingIndex] Block open error: %s!", qPrintable(block.errorString()));
+                return false;
+            }
+
+            data = block.readAll();
+        }
+
+        if (target.write(data) not_eq data.size())
+        {
+            qWarning("[RecordingIndex] Output write error: %s!", qPrintable(target.errorString()));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QVector<QVector<RecordingOverviewNode>> RecordingIndex::buildPyramid(const QVector<RecordingIndexEntry>& entries)
+{
+    QVector<QVector<RecordingOverviewNode>> levels;
+    QVector<RecordingOverviewNode> previous;
+    QVector<quint64> previousBlocks;
+
+    for (const auto& entry : entries)
+    {
+        previous.append({ entry.meanPower, entry.peakPower });
+        previousBlocks.append(1);
+    }
+
+    while (previous.count() > 1)
+    {
+        QVector<RecordingOverviewNode> level;
+        QVector<quint64> levelBlocks;
+
+        for (int i = 0; i < previous.count(); i += 2)
+        {
+            auto node = previous.at(i);
+            auto blocks = previousBlocks.at(i);
+
+            if (i + 1 < previous.count())
+            {
+                const auto& right = previous.at(i + 1);
+                const auto rightBlocks = previousBlocks.at(i + 1);
+
+                node.meanPower = (node.meanPower * blocks + right.meanPower * rightBlocks)
+                               / (blocks + rightBlocks);
+                node.peakPower = qMax(node.peakPower, right.peakPower);
+                blocks += rightBlocks;
+            }
+
+            level.append(node);
+            levelBlocks.append(blocks);
+        }
+
+        levels.append(level);
+        previous = level;
+        previousBlocks = levelBlocks;
+    }
+
+    return levels;
+}
+
+QString RecordingIndex::blockFileName(quint64 blockNumber)
+{
+    return QString::number(blockNumber) + ".bin";
+}
+
+QString RecordingIndex::samplesFileName(SampleFormat format, bool compressed)
+{
+    return QString("samples.") + SampleFormatName(format) + (compressed ? ".z" : "");
+}
+
+bool RecordingIndex::exists(const QString& directory)
+{
+    return QFile::exists(directory + "/" + IndexFileName);
+}
+
+bool RecordingIndex::loadOverview()
+{
+    QFile overview(mDirectory + "/" + OverviewFileName);
+    if (not overview.open(QIODevice::ReadOnly)) return false;
+
+    RecordingOverviewHeader header;
+    if (overview.read(reinterpret_cast<char*>(&header), sizeof(header)) not_eq sizeof(header)
+     or header.magic not_eq OverviewMagic
+     or header.version not_eq IndexVersion
+     or header.entriesCount not_eq static_cast<quint64>(mEntries.count()))
+    {
+        return false;
+    }
+
+    int size = mEntries.count();
+    for (quint32 i = 0; i < header.levelsCount; ++i)
+    {
+        size = (size + 1) / 2;
+
+        QVector<RecordingOverviewNode> level(size);
+        const qint64 bytes = size * sizeof(RecordingOverviewNode);
+        if (overview.read(reinterpret_cast<char*>(level.data()), bytes) not_eq bytes)
+        {
+            mLevels.clear();
+            return false;
+        }
+
+        mLevels.append(level);
+    }
+
+    return size <= 1;
+}
+
+void RecordingIndex::collectEnergetic(int level, int node, float threshold,
+                                      QVector<RecordingRange>& ranges) const
+{
+    if (nodeAt(level, node).peakPower < threshold) return;
+
+    if (level == 0)
+    {
+        if (not ranges.isEmpty() and ranges.last().last == node) ranges.last().last = node + 1;
+        else ranges.append({ node, node + 1 });
+        return;
+    }
+
+    const int below = levelSize(level - 1);
+    for (int child = node * 2; child < node * 2 + 2 and child < below; ++child)
+    {
+        collectEnergetic(level - 1, child, threshold, ranges);
+    }
+}
+
+void RecordingIndex::summarize(int level, int node, const RecordingRange& range,
+                               double& powerSum, quint64& blocks, float& peak) const
+{
+    const int first = node << level;
+    const int last = qMin<int>(mEntries.count(), (node + 1) << level);
+
+    if (last <= range.first or first >= range.last) return;
+
+    if (first >= range.first and last <= range.last)
+    {
+        const auto value = nodeAt(level, node);
+        powerSum += double(value.meanPower) * (last - first);
+        blocks += last - first;
+        peak = qMax(peak, value.peakPower);
+        return;
+    }
+
+    const int below = levelSize(level - 1);
+    for (int child = node * 2; child < node * 2 + 2 and child < below; ++child)
+    {
+        summarize(level - 1, child, range, powerSum, blocks, peak);
+    }
+}
+
+int RecordingIndex::levelSize(int level) const
+{
+    return (level == 0) ? mEntries.count() : mLevels.at(level - 1).count();
+}
+
+RecordingOverviewNode RecordingIndex::nodeAt(int level, int node) const
+{
+    if (level == 0) return { mEntries.at(node).meanPower, mEntries.at(node).peakPower };
+    return mLevels.at(level - 1).at(node);
+}
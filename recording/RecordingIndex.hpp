@@ -0,0 +1,136 @@
+#pragma once
+
+#include <QFile>
+#include <QVector>
+#include <QString>
+
+#include "dsp/SampleConversion.hpp"
+
+// Capture folder index, written next to the "<block number>.bin" files
+// (or a single samples file of a converted capture, see IndexSamplesFile):
+//   index.bin    - RecordingIndexHeader and one RecordingIndexEntry per
+//                  block, appended while recording
+//   overview.bin - RecordingOverviewHeader and pyramid levels 1..N of
+//                  RecordingOverviewNode, each level halves the previous one.
+//                  Written at the end, rebuilt from index.bin if missing.
+// All structures are stored as is, in host byte order.
+
+// RecordingIndexHeader flags
+inline const quint32 IndexSamplesFile = 0x1;        // blocks are concatenated in samplesFileName()
+inline const quint32 IndexCompressed = 0x2;         // the samples file holds qCompress() blocks
+
+struct RecordingIndexHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint64 sampleRate;
+    quint64 frequency;
+    qint64 startTimestamp;  // msecs since epoch
+    quint32 sampleFormat;   // SampleFormat of the stored samples
+    quint32 flags;
+};
+
+// RecordingIndexEntry flags
+inline const quint32 IndexEntryDiscontinuity = 0x1; // samples lost right before the block
+inline const quint32 IndexEntryGainChanged = 0x2;   // RX gain differs from the previous block
+inline const quint32 IndexEntryCompressed = 0x4;    // block stored as a qCompress() buffer
+
+struct RecordingIndexEntry
+{
+    quint64 blockNumber;
+    qint64 timestamp;       // msecs since epoch
+    quint64 offset;         // bytes before this block in the whole recording
+    quint32 size;           // bytes
+    quint32 flags;
+    float meanPower;        // relative to full scale, 1.0 = 0 dBFS
+    float peakPower;
+    float gain;             // RX gain in dB, powers above are as received
+    quint32 clippedSamples;
+};
+
+struct RecordingOverviewNode
+{
+    float meanPower;
+    float peakPower;
+};
+
+struct RecordingOverviewHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint64 entriesCount;
+    quint32 levelsCount;
+    quint32 reserved;
+};
+
+// Range of index entries [first, last)
+struct RecordingRange
+{
+    int first = 0;
+    int last = 0;
+
+    bool isEmpty() const { return first >= last; }
+};
+
+class RecordingIndexWriter
+{
+public:
+    bool open(const QString& directory, quint64 sampleRate, quint64 frequency, qint64 startTimestamp,
+              SampleFormat format = SampleFormat::I16, quint32 flags = 0);
+    // Flushing every entry keeps the index of a killed capture usable
+    bool append(RecordingIndexEntry entry, bool flush = true);
+    bool finish();
+    // Removes index.bin and overview.bin of a failed recording
+    void discard();
+
+    quint64 recordedBytes() const;
+
+private:
+    QString mDirectory;
+    QFile mIndex;
+    quint64 mOffset = 0;
+};
+
+class RecordingIndex
+{
+public:
+    bool load(const QString& directory);
+
+    const QString& directory() const;
+    const RecordingIndexHeader& header() const;
+    const QVector<RecordingIndexEntry>& entries() const;
+    int levelsCount() const;
+
+    // Blocks overlapping [from, to] msecs since the recording start, O(log n)
+    RecordingRange findTimeRange(qint64 fromMs, qint64 toMs) const;
+
+    // Runs of blocks with peak power at or above threshold. Pyramid nodes
+    // below the threshold are skipped whole, so quiet recordings cost O(log n).
+    QVector<RecordingRange> findEnergetic(double thresholdDbfs) const;
+
+    // Aggregated power of a range from the coarsest fitting pyramid nodes
+    RecordingOverviewNode summary(const RecordingRange& range) const;
+
+    // Concatenates samples of the range into output in the stored format,
+    // compressed blocks are unpacked
+    bool extract(const RecordingRange& range, const QString& output) const;
+
+    static QVector<QVector<RecordingOverviewNode>> buildPyramid(const QVector<RecordingIndexEntry>& entries);
+    static QString blockFileName(quint64 blockNumber);
+    static QString samplesFileName(SampleFormat format, bool compressed);
+    static bool exists(const QString& directory);
+
+private:
+    bool loadOverview();
+    void collectEnergetic(int level, int node, float threshold, QVector<RecordingRange>& ranges) const;
+    void summarize(int level, int node, const RecordingRange& range,
+                   double& powerSum, quint64& blocks, float& peak) const;
+    int levelSize(int level) const;
+    RecordingOverviewNode nodeAt(int level, int node) const;
+
+private:
+    QString mDirectory;
+    RecordingIndexHeader mHeader;
+    QVector<RecordingIndexEntry> mEntries;
+    QVector<QVector<RecordingOverviewNode>> mLevels;
+};
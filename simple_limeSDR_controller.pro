@@ -1,7 +1,7 @@
 QT -= gui
 QT += core network
 
-CONFIG += c++17 console
+CONFIG += c++17 console thread
 CONFIG -= app_bundle
 
 TARGET      = simple_limeSDR_controller
@@ -17,19 +17,76 @@ target.path     = $${TARGET}
 
 DEFINES += QT_DEPRECATED_WARNINGS
 
-LIBS += -lLimeSuite
+LIBS += -lLimeSuite -lrt
 
 SOURCES += \
         Application.cpp \
+        dsp/AgcController.cpp \
+        dsp/BlockStatistics.cpp \
+        dsp/Fft.cpp \
+        dsp/IqCorrection.cpp \
+        dsp/OverlapSaveCorrelator.cpp \
+        dsp/PolyphaseChannelizer.cpp \
+        dsp/RationalResampler.cpp \
+        dsp/SampleConversion.cpp \
         hardware/LimeSDRDevice.cpp \
+        ipc/SharedMemoryRing.cpp \
         main.cpp \
+        pipeline/AbstractPipelineStage.cpp \
+        pipeline/Pipeline.cpp \
+        pipeline/SampleBlockPool.cpp \
+        pipeline/WorkStealingThreadPool.cpp \
+        playback/TxFileSource.cpp \
+        recording/RecordingIndex.cpp \
+        stages/CallbackStage.cpp \
+        stages/ChannelizerStage.cpp \
+        stages/CircularRecorderStage.cpp \
+        stages/FileRecorderStage.cpp \
+        stages/IqCorrectionStage.cpp \
+        stages/PreambleDetectorStage.cpp \
+        stages/RecordingIndexStage.cpp \
+        stages/SharedMemoryStage.cpp \
+        tools/Benchmark.cpp \
+        tools/CaptureConverter.cpp \
+        tools/IndexQuery.cpp \
+        tracing/Tracer.cpp \
         types/RxMissionConfig.cpp \
         types/TxMissionConfig.cpp
 
 HEADERS += \
         Application.hpp \
+        dsp/AgcController.hpp \
+        dsp/BlockStatistics.hpp \
+        dsp/Fft.hpp \
+        dsp/IqCorrection.hpp \
+        dsp/OverlapSaveCorrelator.hpp \
+        dsp/PolyphaseChannelizer.hpp \
+        dsp/RationalResampler.hpp \
+        dsp/SampleConversion.hpp \
         hardware/LimeSDRDevice.hpp \
+        ipc/SharedMemoryRing.hpp \
+        pipeline/AbstractPipelineStage.hpp \
+        pipeline/Pipeline.hpp \
+        pipeline/SampleBlock.hpp \
+        pipeline/SampleBlockPool.hpp \
+        pipeline/WorkStealingThreadPool.hpp \
+        playback/TxFileSource.hpp \
+        recording/RecordingIndex.hpp \
+        stages/CallbackStage.hpp \
+        stages/ChannelizerStage.hpp \
+        stages/CircularRecorderStage.hpp \
+        stages/FileRecorderStage.hpp \
+        stages/IqCorrectionStage.hpp \
+        stages/PreambleDetectorStage.hpp \
+        stages/RecordingIndexStage.hpp \
+        stages/SharedMemoryStage.hpp \
+        tools/Benchmark.hpp \
+        tools/CaptureConverter.hpp \
+        tools/IndexQuery.hpp \
+        tracing/Tracer.hpp \
         types/AbstractMissionConfig.hpp \
+        types/CaptureConversionConfig.hpp \
+        types/IndexQueryConfig.hpp \
         types/RxMissionConfig.hpp \
         types/TxMissionConfig.hpp
 
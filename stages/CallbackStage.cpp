@@ -0,0 +1,14 @@
+#include "CallbackStage.hpp"
+
+CallbackStage::CallbackStage(const QString& name, const Callback& callback)
+    : AbstractPipelineStage(name)
+    , mCallback(callback)
+{
+
+}
+
+SampleBlockPtr CallbackStage::process(const SampleBlockPtr& block)
+{
+    mCallback(block);
+    return block;
+}
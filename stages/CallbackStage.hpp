@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// Sink calling a function for every block, e.g. to emit a Qt signal
+class CallbackStage : public AbstractPipelineStage
+{
+public:
+    using Callback = std::function<void(const SampleBlockPtr& block)>;
+
+public:
+    CallbackStage(const QString& name, const Callback& callback);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+
+private:
+    Callback mCallback;
+};
@@ -0,0 +1,65 @@
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "ChannelizerStage.hpp"
+
+ChannelizerStage::ChannelizerStage(const QString& directory, unsigned channels)
+    : AbstractPipelineStage("channelizer")
+    , mDirectory(directory)
+    , mChannelizer(channels)
+{
+
+}
+
+SampleBlockPtr ChannelizerStage::process(const SampleBlockPtr& block)
+{
+    if (mOutputs.isEmpty() and not openOutputs())
+    {
+        reportError();
+        return block;
+    }
+
+    for (auto& buffer : mChannelBuffers) buffer.resize(0);
+
+    mChannelizer.process(reinterpret_cast<const qint16*>(block->data.constData()),
+                         block->data.size() / SampleSize, mChannelBuffers,
+                         &WorkStealingThreadPool::globalInstance());
+
+    for (int k = 0; k < mOutputs.count(); ++k)
+    {
+        if (mChannelBuffers.at(k).isEmpty()) continue;
+
+        if (mOutputs[k]->write(mChannelBuffers.at(k)) not_eq mChannelBuffers.at(k).size())
+        {
+            qWarning("[ChannelizerStage] Channel %i write error: %s!",
+                     k, qPrintable(mOutputs[k]->errorString()));
+            reportError();
+        }
+    }
+
+    return block;
+}
+
+void ChannelizerStage::finish()
+{
+    for (auto& output : mOutputs) output->close();
+    mOutputs.clear();
+}
+
+bool ChannelizerStage::openOutputs()
+{
+    for (unsigned k = 0; k < mChannelizer.channels(); ++k)
+    {
+        auto output = std::make_shared<QFile>(mDirectory + "/channel_" + QString::number(k) + ".bin");
+        if (not output->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qWarning("[ChannelizerStage] Channel %u output open error: %s!",
+                     k, qPrintable(output->errorString()));
+            mOutputs.clear();
+            return false;
+        }
+
+        mOutputs.append(output);
+    }
+
+    mChannelBuffers.resize(mChannelizer.channels());
+    return true;
+}
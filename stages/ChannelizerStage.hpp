@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QFile>
+#include <QVector>
+
+#include <memory>
+
+#include "dsp/PolyphaseChannelizer.hpp"
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// Splits the capture into N decimated channels and appends channel k
+// to "channel_<k>.bin" in the capture directory
+class ChannelizerStage : public AbstractPipelineStage
+{
+public:
+    ChannelizerStage(const QString& directory, unsigned channels);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+    void finish() override;
+
+private:
+    bool openOutputs();
+
+private:
+    QString mDirectory;
+    PolyphaseChannelizer mChannelizer;
+    QVector<QByteArray> mChannelBuffers;
+    QVector<std::shared_ptr<QFile>> mOutputs;
+};
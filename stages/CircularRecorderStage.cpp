@@ -0,0 +1,248 @@
+#include <fcntl.h>
+
+#include <algorithm>
+
+#include "CircularRecorderStage.hpp"
+
+inline const quint32 ExportChunkBlocks = 64;
+// Extra ring slots the writer fills while an export reads the oldest blocks
+inline const quint32 RingMarginBlocks = 64;
+
+std::atomic_bool CircularRecorderStage::sDumpRequested = false;
+
+CircularRecorderStage::CircularRecorderStage(const QString& directory, quint32 blocksCount, quint32 blockSize)
+    : AbstractPipelineStage("circular recorder")
+    , mDirectory(directory)
+    , mBlocksCount(blocksCount ? blocksCount : 1)
+    , mSlotsCount(mBlocksCount + RingMarginBlocks)
+    , mBlockSize(blockSize)
+{
+    // Dumps requested before the mission are not about this capture
+    sDumpRequested.store(false);
+}
+
+CircularRecorderStage::~CircularRecorderStage()
+{
+    finish();
+}
+
+SampleBlockPtr CircularRecorderStage::process(const SampleBlockPtr& block)
+{
+    if (not mPrepared)
+    {
+        mPrepared = prepareRing();
+        if (not mPrepared)
+        {
+            reportError();
+            return block;
+        }
+    }
+
+    const quint64 written = mWritten.load();
+    if (written == 0) mFirstBlock = block->number;
+
+    // A block that is not written still takes its slot, so the ring
+    // position keeps matching the block number and dumps stay in line
+    const quint64 slot = written % mSlotsCount;
+    bool valid = true;
+    if (static_cast<quint32>(block->data.size()) not_eq mBlockSize)
+    {
+        qWarning("[CircularRecorderStage] Unexpected block size %i!", block->data.size());
+        reportError();
+        valid = false;
+    }
+    else if (not mRing->seek(qint64(slot) * mBlockSize)
+          or mRing->write(block->data) not_eq block->data.size())
+    {
+        qWarning("[CircularRecorderStage] Ring write error: %s!", qPrintable(mRing->errorString()));
+        reportError();
+        valid = false;
+    }
+
+    mSlotValid[slot].store(valid);
+    mWritten.store(written + 1);
+
+    if (sDumpRequested.exchange(false)) freeze();
+
+    return block;
+}
+
+void CircularRecorderStage::finish()
+{
+    // Queued dumps are exported before the ring is gone
+    if (mExportThread and mExportThread->joinable()) mExportThread->join();
+    mExportThread.reset();
+
+    // The ring is scratch space, only dumps are kept
+    if (mRing)
+    {
+        mRing->close();
+        mRing->remove();
+        mRing.reset();
+    }
+
+    mPrepared = false;
+}
+
+void CircularRecorderStage::requestDump()
+{
+    sDumpRequested.store(true);
+}
+
+bool CircularRecorderStage::prepareRing()
+{
+    const qint64 size = qint64(mSlotsCount) * mBlockSize;
+
+    // Unbuffered: the export thread reads blocks right after they are written
+    mRing.reset(new QFile(mDirectory + "/ring.bin"));
+    mSlotValid.reset(new std::atomic_bool[mSlotsCount]());
+    mWritten.store(0);
+
+    if (not mRing->open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        qWarning("[CircularRecorderStage] Ring open error: %s!", qPrintable(mRing->errorString()));
+        return false;
+    }
+
+    // Allocate now, so a full disk is found at start and not minutes later
+    if (posix_fallocate(mRing->handle(), 0, size) not_eq 0)
+    {
+        qWarning("[CircularRecorderStage] Can't preallocate %lld bytes for ring!", size);
+        return false;
+    }
+
+    qDebug("[CircularRecorderStage] Ring of %u blocks prepared.", mSlotsCount);
+    return true;
+}
+
+void CircularRecorderStage::freeze()
+{
+    if (mWritten.load() == 0)
+    {
+        qInfo("[CircularRecorderStage] Ring is empty, nothing to dump.");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mExportMutex);
+    mExportQueue.push_back({ mWritten.load(), mFirstBlock, mDumpsCount++ });
+
+    if (mExporting)
+    {
+        qInfo("[CircularRecorderStage] Previous dump is still exporting, request queued.");
+        return;
+    }
+
+    // The previous export thread has left its loop already
+    if (mExportThread and mExportThread->joinable()) mExportThread->join();
+
+    mExporting = true;
+    mExportThread.reset(new std::thread(&CircularRecorderStage::exportRoutine, this));
+}
+
+void CircularRecorderStage::exportRoutine()
+{
+    while (true)
+    {
+        Snapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mExportMutex);
+            if (mExportQueue.empty())
+            {
+                mExporting = false;
+                return;
+            }
+
+            snapshot = mExportQueue.front();
+            mExportQueue.pop_front();
+        }
+
+        exportSnapshot(snapshot);
+    }
+}
+
+void CircularRecorderStage::exportSnapshot(const Snapshot& snapshot)
+{
+    const quint64 blocks = qMin<quint64>(snapshot.written, mBlocksCount);
+    const QString fileName = mDirectory + "/dump_" + QString::number(snapshot.dumpNumber) + ".bin";
+
+    QFile output(fileName);
+    if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[CircularRecorderStage] Dump open error: %s!", qPrintable(output.errorString()));
+        return;
+    }
+
+    QFile input(mRing->fileName());
+    if (not input.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        qWarning("[CircularRecorderStage] Ring read error: %s!", qPrintable(input.errorString()));
+        return;
+    }
+
+    QByteArray buffer;
+    QVector<char> valid;
+    quint64 position = snapshot.written - blocks;
+    quint64 lost = 0;
+    quint64 missing = 0;
+    while (position < snapshot.written)
+    {
+        // Oldest block first, contiguous slots are copied in one read
+        const quint64 slot = position % mSlotsCount;
+        const quint64 count = std::min<quint64>({ snapshot.written - position, mSlotsCount - slot,
+                                                  ExportChunkBlocks });
+
+        buffer.resize(count * mBlockSize);
+        if (not input.seek(slot * mBlockSize)
+         or input.read(buffer.data(), buffer.size()) not_eq buffer.size())
+        {
+            qWarning("[CircularRecorderStage] Ring read error: %s!", qPrintable(input.errorString()));
+            return;
+        }
+
+        // Flags are taken before mWritten: a flag of a newer block in the
+        // same slot means that slot is counted as overwritten below
+        valid.resize(count);
+        for (quint64 i = 0; i < count; ++i) valid[i] = mSlotValid[slot + i].load();
+
+        // The writer may be writing block mWritten now: blocks a ring
+        // length behind it and older could be overwritten during the read
+        const quint64 written = mWritten.load();
+        const quint64 oldestValid = (written + 1 > mSlotsCount) ? written + 1 - mSlotsCount : 0;
+        const quint64 overwritten = (oldestValid > position) ? qMin(count, oldestValid - position) : 0;
+
+        // Blocks that failed to reach the ring are zeroed to keep the timing
+        for (quint64 i = overwritten; i < count; ++i)
+        {
+            if (valid.at(i)) continue;
+
+            std::fill_n(buffer.data() + i * mBlockSize, mBlockSize, 0);
+            ++missing;
+        }
+
+        const qint64 size = (count - overwritten) * mBlockSize;
+        if (output.write(buffer.constData() + overwritten * mBlockSize, size) not_eq size)
+        {
+            qWarning("[CircularRecorderStage] Dump export error: %s!", qPrintable(output.errorString()));
+            return;
+        }
+
+        lost += overwritten;
+        position += count;
+    }
+
+    const quint64 lastBlock = snapshot.firstBlock + snapshot.written - 1;
+    qInfo("[CircularRecorderStage] Dump '%s' saved: blocks %llu - %llu.",
+          qPrintable(fileName), lastBlock - blocks + 1, lastBlock);
+
+    if (lost > 0)
+    {
+        qWarning("[CircularRecorderStage] Dump '%s': %llu blocks were overwritten before export!",
+                 qPrintable(fileName), lost);
+    }
+
+    if (missing > 0)
+    {
+        qWarning("[CircularRecorderStage] Dump '%s': %llu blocks were not recorded, zeros are saved instead!",
+                 qPrintable(fileName), missing);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QFile>
+#include <QVector>
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// "Time machine" recorder: keeps the last blocksCount blocks in a
+// preallocated ring file instead of one file per block. requestDump()
+// snapshots the ring position and a background thread exports the last
+// blocksCount blocks before it in block order into "dump_<N>.bin", while
+// recording goes on into the same ring, so every dump holds full history.
+// Requests arriving during an export are queued. The ring has a margin of
+// spare slots; if the writer still overtakes a slow export, the overwritten
+// oldest blocks are skipped and reported. Blocks that failed to be written
+// keep their slot and are exported as zeros.
+class CircularRecorderStage : public AbstractPipelineStage
+{
+public:
+    CircularRecorderStage(const QString& directory, quint32 blocksCount, quint32 blockSize);
+    ~CircularRecorderStage();
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+    void finish() override;
+
+    // Async-signal-safe, the dump happens on the next processed block
+    static void requestDump();
+
+private:
+    struct Snapshot
+    {
+        quint64 written;
+        quint64 firstBlock;
+        quint32 dumpNumber;
+    };
+
+    bool prepareRing();
+    void freeze();
+    void exportRoutine();
+    void exportSnapshot(const Snapshot& snapshot);
+
+private:
+    QString mDirectory;
+    quint32 mBlocksCount;
+    quint32 mSlotsCount;
+    quint32 mBlockSize;
+    bool mPrepared = false;
+
+    std::unique_ptr<QFile> mRing;
+    std::unique_ptr<std::atomic_bool[]> mSlotValid;
+    std::atomic<quint64> mWritten = 0;
+    quint64 mFirstBlock = 0;
+
+    std::mutex mExportMutex;
+    std::deque<Snapshot> mExportQueue;
+    std::unique_ptr<std::thread> mExportThread;
+    bool mExporting = false;
+    quint32 mDumpsCount = 0;
+
+    static std::atomic_bool sDumpRequested;
+};
@@ -0,0 +1,25 @@
+#include <QFile>
+
+#include "FileRecorderStage.hpp"
+
+FileRecorderStage::FileRecorderStage(const QString& directory)
+    : AbstractPipelineStage("recorder")
+    , mDirectory(directory)
+{
+
+}
+
+SampleBlockPtr FileRecorderStage::process(const SampleBlockPtr& block)
+{
+    QFile output(mDirectory + "/" + QString::number(block->number) + ".bin");
+
+    if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate)
+     or output.write(block->data) not_eq block->data.size())
+    {
+        qWarning("[FileRecorderStage] Rx output write error: %s!",
+                 qPrintable(output.errorString()));
+        reportError();
+    }
+
+    return block;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// Writes every block into its own "<block number>.bin" file
+class FileRecorderStage : public AbstractPipelineStage
+{
+public:
+    explicit FileRecorderStage(const QString& directory);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+
+private:
+    QString mDirectory;
+};
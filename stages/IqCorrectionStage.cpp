@@ -0,0 +1,71 @@
+#include <cmath>
+
+#include "dsp/IqCorrection.hpp"
+#include "IqCorrectionStage.hpp"
+
+IqCorrectionStage::IqCorrectionStage(SampleBlockPool& pool, double smoothing)
+    : AbstractPipelineStage("iq correction")
+    , mPool(pool)
+    , mSmoothing(smoothing)
+{
+
+}
+
+SampleBlockPtr IqCorrectionStage::process(const SampleBlockPtr& block)
+{
+    const auto samples = reinterpret_cast<const qint16*>(block->data.constData());
+    const size_t count = block->data.size() / SampleSize;
+
+    if (count == 0) return block;
+
+    IqMoments moments;
+    AccumulateIqMoments(samples, count, moments);
+
+    const double meanI = moments.sumI / count;
+    const double meanQ = moments.sumQ / count;
+    const double varianceI = moments.sumII / count - meanI * meanI;
+    const double varianceQ = moments.sumQQ / count - meanQ * meanQ;
+    const double covarianceIQ = moments.sumIQ / count - meanI * meanQ;
+
+    const double weight = mInitialized ? mSmoothing : 1.0;
+    mMeanI += weight * (meanI - mMeanI);
+    mMeanQ += weight * (meanQ - mMeanQ);
+    mVarianceI += weight * (varianceI - mVarianceI);
+    mVarianceQ += weight * (varianceQ - mVarianceQ);
+    mCovarianceIQ += weight * (covarianceIQ - mCovarianceIQ);
+    mInitialized = true;
+
+    IqCorrectionParameters parameters;
+    parameters.dcI = mMeanI;
+    parameters.dcQ = mMeanQ;
+
+    // Q part orthogonal to I, scaled to the I power
+    const double residualQ = (mVarianceI > 0) ? mVarianceQ - mCovarianceIQ * mCovarianceIQ / mVarianceI : 0;
+    if (mVarianceI > 0 and residualQ > 0)
+    {
+        parameters.cross = mCovarianceIQ / mVarianceI;
+        parameters.scale = std::sqrt(mVarianceI / residualQ);
+    }
+
+    const double gainImbalance = (mVarianceI > 0 and mVarianceQ > 0)
+                               ? 10 * std::log10(mVarianceQ / mVarianceI) : 0;
+    const double phaseError = (mVarianceI > 0 and mVarianceQ > 0)
+                            ? std::asin(qBound(-1.0, mCovarianceIQ / std::sqrt(mVarianceI * mVarianceQ), 1.0))
+                              * 180 / M_PI
+                            : 0;
+
+    qDebug("[IqCorrectionStage] Block %llu: dc %.2f/%.2f | gain imbalance %.3f dB | phase %.3f deg",
+           block->number, mMeanI, mMeanQ, gainImbalance, phaseError);
+
+    // Keeps the block metadata (discontinuity, gain), statistics are of the uncorrected samples
+    auto output = mPool.acquire();
+    auto data = std::move(output->data);
+    *output = *block;
+    output->hasStatistics = false;
+    output->data = std::move(data);
+    output->data.resize(block->data.size());
+
+    ApplyIqCorrection(samples, reinterpret_cast<qint16*>(output->data.data()), count, parameters);
+
+    return output;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pipeline/AbstractPipelineStage.hpp"
+#include "pipeline/SampleBlockPool.hpp"
+
+// Tracks DC offset and IQ gain/phase imbalance with an exponential average
+// of per-block moments and writes corrected blocks downstream. Output blocks
+// come from the capture pool, which must outlive the stage.
+class IqCorrectionStage : public AbstractPipelineStage
+{
+public:
+    // smoothing is the weight of the newest block in the running estimate
+    explicit IqCorrectionStage(SampleBlockPool& pool, double smoothing = 0.05);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+
+private:
+    SampleBlockPool& mPool;
+    double mSmoothing;
+    bool mInitialized = false;
+
+    double mMeanI = 0;
+    double mMeanQ = 0;
+    double mVarianceI = 0;
+    double mVarianceQ = 0;
+    double mCovarianceIQ = 0;
+};
@@ -0,0 +1,200 @@
+#include <cmath>
+
+#include "dsp/BlockStatistics.hpp"
+#include "dsp/SampleConversion.hpp"
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "PreambleDetectorStage.hpp"
+
+bool PreambleDetectorStage::loadReference(const QString& fileName, std::vector<std::complex<float>>& reference)
+{
+    QFile input(fileName);
+    if (not input.open(QIODevice::ReadOnly))
+    {
+        qWarning("[PreambleDetectorStage] Reference open error: %s!", qPrintable(input.errorString()));
+        return false;
+    }
+
+    const auto data = input.readAll();
+    const size_t count = data.size() / SampleSize;
+    if (count < 2)
+    {
+        qWarning("[PreambleDetectorStage] Reference '%s' is too short!", qPrintable(fileName));
+        return false;
+    }
+
+    reference.resize(count);
+    ConvertToFloat(data.constData(), SampleFormat::I16, count, reinterpret_cast<float*>(reference.data()));
+    return true;
+}
+
+quint64 PreambleDetectorStage::historySamples(size_t referenceLength, quint32 windowSamples)
+{
+    return OverlapSaveCorrelator::defaultFftSize(referenceLength) + referenceLength + windowSamples;
+}
+
+PreambleDetectorStage::PreambleDetectorStage(const QString& directory,
+                                             const std::vector<std::complex<float>>& reference,
+                                             float threshold, quint32 windowSamples, quint64 sampleRate)
+    : AbstractPipelineStage("preamble")
+    , mDirectory(directory)
+    , mCorrelator(reference, threshold)
+    , mWindowSamples(windowSamples)
+    , mSampleRate(sampleRate)
+{
+
+}
+
+SampleBlockPtr PreambleDetectorStage::process(const SampleBlockPtr& block)
+{
+    if (not mOutput.isOpen() and not openOutput())
+    {
+        reportError();
+        return block;
+    }
+
+    mHistory.push_back(block);
+    mHistoryEnd += block->data.size() / SampleSize;
+
+    mDetections.clear();
+    mCorrelator.process(reinterpret_cast<const qint16*>(block->data.constData()),
+                        block->data.size() / SampleSize, mDetections,
+                        &WorkStealingThreadPool::globalInstance());
+
+    for (const auto& detection : mDetections) report(detection);
+
+    saveWindows(false);
+    trimHistory();
+    return block;
+}
+
+void PreambleDetectorStage::finish()
+{
+    if (not mOutput.isOpen()) return;
+
+    mDetections.clear();
+    mCorrelator.finish(mDetections);
+    for (const auto& detection : mDetections) report(detection);
+
+    // Windows cut by the mission end are saved as is
+    saveWindows(true);
+
+    mOutput.close();
+    mHistory.clear();
+
+    qInfo("[PreambleDetectorStage] %llu preambles detected.", mDetectionsCount);
+}
+
+bool PreambleDetectorStage::openOutput()
+{
+    mOutput.setFileName(mDirectory + "/detections.csv");
+    if (not mOutput.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[PreambleDetectorStage] Output open error: %s!", qPrintable(mOutput.errorString()));
+        return false;
+    }
+
+    mOutput.write("detection,block,sample,timestamp_ms,metric,snr_db,power_dbfs,phase_rad\n");
+    return true;
+}
+
+void PreambleDetectorStage::report(const OverlapSaveCorrelator::Detection& detection)
+{
+    // Locate the block holding the first preamble sample
+    quint64 blockBegin = mHistoryBegin;
+    SampleBlockPtr block;
+    for (const auto& candidate : mHistory)
+    {
+        const quint64 blockEnd = blockBegin + candidate->data.size() / SampleSize;
+        if (detection.position < blockEnd)
+        {
+            block = candidate;
+            break;
+        }
+        blockBegin = blockEnd;
+    }
+
+    const double timestamp = block ? block->timestamp + (detection.position - blockBegin) * 1000.0 / mSampleRate
+                                   : 0.0;
+    const double snrDb = (detection.metric < 1.0f) ? 10 * std::log10(detection.metric / (1.0 - detection.metric))
+                                                   : INFINITY;
+
+    const auto line = QString("%1,%2,%3,%4,%5,%6,%7,%8\n")
+            .arg(mDetectionsCount)
+            .arg(block ? block->number : 0)
+            .arg(detection.position)
+            .arg(timestamp, 0, 'f', 3)
+            .arg(detection.metric, 0, 'f', 4)
+            .arg(snrDb, 0, 'f', 1)
+            .arg(PowerToDbfs(detection.windowPower), 0, 'f', 1)
+            .arg(detection.phase, 0, 'f', 3)
+            .toUtf8();
+
+    if (mOutput.write(line) not_eq line.size())
+    {
+        qWarning("[PreambleDetectorStage] Output write error: %s!", qPrintable(mOutput.errorString()));
+        reportError();
+    }
+
+    if (mWindowSamples)
+    {
+        mWindows.push_back({ mDetectionsCount, detection.position, detection.position + mWindowSamples });
+    }
+
+    ++mDetectionsCount;
+}
+
+bool PreambleDetectorStage::saveWindow(const Window& window)
+{
+    QFile output(mDirectory + "/window_" + QString::number(window.number) + ".bin");
+    if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[PreambleDetectorStage] Window open error: %s!", qPrintable(output.errorString()));
+        return false;
+    }
+
+    quint64 blockBegin = mHistoryBegin;
+    for (const auto& block : mHistory)
+    {
+        const quint64 blockEnd = blockBegin + block->data.size() / SampleSize;
+        const quint64 begin = qMax(blockBegin, window.begin);
+        const quint64 end = qMin(blockEnd, window.end);
+
+        if (begin < end)
+        {
+            const qint64 bytes = (end - begin) * SampleSize;
+            if (output.write(block->data.constData() + (begin - blockBegin) * SampleSize, bytes) not_eq bytes)
+            {
+                qWarning("[PreambleDetectorStage] Window write error: %s!", qPrintable(output.errorString()));
+                return false;
+            }
+        }
+
+        blockBegin = blockEnd;
+    }
+
+    return true;
+}
+
+void PreambleDetectorStage::saveWindows(bool force)
+{
+    while (not mWindows.empty() and (force or mWindows.front().end <= mHistoryEnd))
+    {
+        if (not saveWindow(mWindows.front())) reportError();
+        mWindows.pop_front();
+    }
+}
+
+void PreambleDetectorStage::trimHistory()
+{
+    quint64 keepFrom = mCorrelator.pendingFrom();
+    if (not mWindows.empty()) keepFrom = qMin(keepFrom, mWindows.front().begin);
+
+    while (not mHistory.empty())
+    {
+        const quint64 blockEnd = mHistoryBegin + mHistory.front()->data.size() / SampleSize;
+        if (blockEnd > keepFrom) break;
+
+        mHistoryBegin = blockEnd;
+        mHistory.pop_front();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QFile>
+
+#include <deque>
+#include <vector>
+#include <complex>
+
+#include "dsp/OverlapSaveCorrelator.hpp"
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// Matched filter against a known preamble. Every detection is appended to
+// "detections.csv" in the capture directory; with windowSamples set, the
+// samples starting at the preamble are also saved to "window_<N>.bin".
+// Blocks are kept only until the correlator and pending windows are past them.
+class PreambleDetectorStage : public AbstractPipelineStage
+{
+public:
+    // Reference is interleaved I16 IQ, as recorded by RX
+    static bool loadReference(const QString& fileName, std::vector<std::complex<float>>& reference);
+
+    // Upper bound of the history span: correlator input, peak and the longest open window
+    static quint64 historySamples(size_t referenceLength, quint32 windowSamples);
+
+public:
+    PreambleDetectorStage(const QString& directory, const std::vector<std::complex<float>>& reference,
+                          float threshold, quint32 windowSamples, quint64 sampleRate);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+    void finish() override;
+
+private:
+    struct Window
+    {
+        quint64 number;
+        quint64 begin;
+        quint64 end;
+    };
+
+    bool openOutput();
+    void report(const OverlapSaveCorrelator::Detection& detection);
+    bool saveWindow(const Window& window);
+    void saveWindows(bool force);
+    void trimHistory();
+
+private:
+    QString mDirectory;
+    OverlapSaveCorrelator mCorrelator;
+    quint32 mWindowSamples;
+    quint64 mSampleRate;
+
+    QFile mOutput;
+    std::vector<OverlapSaveCorrelator::Detection> mDetections;
+    quint64 mDetectionsCount = 0;
+
+    // Recent blocks, the first one starts at mHistoryBegin sample
+    std::deque<SampleBlockPtr> mHistory;
+    quint64 mHistoryBegin = 0;
+    quint64 mHistoryEnd = 0;
+    std::deque<Window> mWindows;
+};
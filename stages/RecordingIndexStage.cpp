@@ -0,0 +1,53 @@
+#include "dsp/BlockStatistics.hpp"
+#include "RecordingIndexStage.hpp"
+
+RecordingIndexStage::RecordingIndexStage(const QString& directory, quint64 sampleRate, quint64 frequency)
+    : AbstractPipelineStage("index")
+    , mDirectory(directory)
+    , mSampleRate(sampleRate)
+    , mFrequency(frequency)
+{
+
+}
+
+SampleBlockPtr RecordingIndexStage::process(const SampleBlockPtr& block)
+{
+    if (not mOpened)
+    {
+        mOpened = mWriter.open(mDirectory, mSampleRate, mFrequency, block->timestamp);
+        if (not mOpened)
+        {
+            reportError();
+            return block;
+        }
+    }
+
+    BlockStatistics statistics = block->statistics;
+    if (not block->hasStatistics)
+    {
+        AccumulateBlockStatistics(reinterpret_cast<const qint16*>(block->data.constData()),
+                                  block->data.size() / SampleSize, statistics);
+    }
+
+    RecordingIndexEntry entry;
+    entry.blockNumber = block->number;
+    entry.timestamp = block->timestamp;
+    entry.offset = 0;
+    entry.size = block->data.size();
+    entry.flags = (block->discontinuity ? IndexEntryDiscontinuity : 0)
+                | (block->gainChanged ? IndexEntryGainChanged : 0);
+    entry.meanPower = statistics.meanPower() / FullScalePower;
+    entry.peakPower = statistics.peakPower / FullScalePower;
+    entry.gain = block->gain;
+    entry.clippedSamples = statistics.clippedSamples;
+
+    if (not mWriter.append(entry)) reportError();
+
+    return block;
+}
+
+void RecordingIndexStage::finish()
+{
+    if (mOpened and not mWriter.finish()) reportError();
+    mOpened = false;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "recording/RecordingIndex.hpp"
+#include "pipeline/AbstractPipelineStage.hpp"
+
+// Appends power statistics of every recorded block to the capture index
+class RecordingIndexStage : public AbstractPipelineStage
+{
+public:
+    RecordingIndexStage(const QString& directory, quint64 sampleRate, quint64 frequency);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+    void finish() override;
+
+private:
+    QString mDirectory;
+    quint64 mSampleRate;
+    quint64 mFrequency;
+    bool mOpened = false;
+    RecordingIndexWriter mWriter;
+};
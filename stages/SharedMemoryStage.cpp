@@ -0,0 +1,19 @@
+#include "ipc/SharedMemoryRing.hpp"
+#include "SharedMemoryStage.hpp"
+
+SharedMemoryStage::SharedMemoryStage(SharedMemoryRingWriter& writer)
+    : AbstractPipelineStage("shared memory")
+    , mWriter(writer)
+{
+
+}
+
+SampleBlockPtr SharedMemoryStage::process(const SampleBlockPtr& block)
+{
+    if (not mWriter.publish(block->data.constData(), block->data.size(), block->timestamp))
+    {
+        reportError();
+    }
+
+    return block;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "pipeline/AbstractPipelineStage.hpp"
+
+class SharedMemoryRingWriter;
+
+// Publishes every block into a shared memory ring owned by the caller
+class SharedMemoryStage : public AbstractPipelineStage
+{
+public:
+    explicit SharedMemoryStage(SharedMemoryRingWriter& writer);
+
+    SampleBlockPtr process(const SampleBlockPtr& block) override;
+
+private:
+    SharedMemoryRingWriter& mWriter;
+};
@@ -0,0 +1,123 @@
+#include <QString>
+#include <QElapsedTimer>
+
+#include <random>
+
+#include "dsp/OverlapSaveCorrelator.hpp"
+#include "dsp/PolyphaseChannelizer.hpp"
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "Benchmark.hpp"
+
+inline const size_t BenchmarkBlockSamples = 1 << 20;
+inline const qint64 BenchmarkDurationMs = 2000;
+
+static QByteArray NoiseBlock(size_t samples)
+{
+    QByteArray block(samples * sizeof(qint16) * 2, Qt::Uninitialized);
+    auto data = reinterpret_cast<qint16*>(block.data());
+
+    std::mt19937 generator(1);
+    std::normal_distribution<float> noise(0, 1000);
+    for (size_t i = 0; i < samples * 2; ++i) data[i] = static_cast<qint16>(noise(generator));
+
+    return block;
+}
+
+static void BenchmarkChannelizer()
+{
+    const auto input = NoiseBlock(BenchmarkBlockSamples);
+    const auto samples = reinterpret_cast<const qint16*>(input.constData());
+    auto& pool = WorkStealingThreadPool::globalInstance();
+
+    for (unsigned channels : { 8u, 64u, 512u, 4096u })
+    {
+        for (bool parallel : { false, true })
+        {
+            PolyphaseChannelizer channelizer(channels);
+            QVector<QByteArray> outputs;
+            QElapsedTimer timer;
+            size_t consumed = 0;
+            size_t frames = 0;
+
+            timer.start();
+            while (timer.elapsed() < BenchmarkDurationMs)
+            {
+                for (auto& output : outputs) output.resize(0);
+                frames += channelizer.process(samples, BenchmarkBlockSamples, outputs,
+                                              parallel ? &pool : nullptr);
+                consumed += BenchmarkBlockSamples;
+            }
+
+            const double seconds = timer.nsecsElapsed() / 1e9;
+            const unsigned cores = parallel ? pool.threadsCount() : 1;
+            const double inputRate = consumed / seconds;
+            const double frameRate = frames / seconds;
+
+            // Every frame gives one sample to each of the N channels
+            qInfo("[Benchmark] channelizer %4u channels | %2u cores | input %8.2f Msps | "
+                  "per core: %8.2f M channel samples/s, %10.0f frames/s",
+                  channels, cores, inputRate / 1e6,
+                  frameRate * channels / cores / 1e6, frameRate / cores);
+        }
+    }
+}
+
+static void BenchmarkCorrelator()
+{
+    const auto input = NoiseBlock(BenchmarkBlockSamples);
+    const auto samples = reinterpret_cast<const qint16*>(input.constData());
+    auto& pool = WorkStealingThreadPool::globalInstance();
+
+    std::mt19937 generator(2);
+    std::uniform_int_distribution<int> bit(0, 1);
+
+    for (size_t length : { 63u, 255u, 1023u, 4095u })
+    {
+        // QPSK sequence, noise never crosses the threshold
+        std::vector<std::complex<float>> reference(length);
+        for (auto& sample : reference) sample = { bit(generator) ? 1000.0f : -1000.0f,
+                                                  bit(generator) ? 1000.0f : -1000.0f };
+
+        for (bool parallel : { false, true })
+        {
+            OverlapSaveCorrelator correlator(reference, 0.5f);
+            std::vector<OverlapSaveCorrelator::Detection> detections;
+            QElapsedTimer timer;
+            size_t consumed = 0;
+
+            timer.start();
+            while (timer.elapsed() < BenchmarkDurationMs)
+            {
+                correlator.process(samples, BenchmarkBlockSamples, detections, parallel ? &pool : nullptr);
+                consumed += BenchmarkBlockSamples;
+            }
+
+            const double seconds = timer.nsecsElapsed() / 1e9;
+            const unsigned cores = parallel ? pool.threadsCount() : 1;
+            const double inputRate = consumed / seconds;
+
+            qInfo("[Benchmark] correlator %4zu taps | fft %5zu | %2u cores | input %8.2f Msps | "
+                  "per core %8.2f Msps | %zu detections",
+                  length, correlator.fftSize(), cores, inputRate / 1e6, inputRate / cores / 1e6,
+                  detections.size());
+        }
+    }
+}
+
+bool RunBenchmark(const QString& name)
+{
+    if (name == "channelizer") BenchmarkChannelizer();
+    else if (name == "correlator") BenchmarkCorrelator();
+    else
+    {
+        qWarning("Unknown benchmark '%s'! Available: %s", qPrintable(name), BenchmarkNames());
+        return false;
+    }
+
+    return true;
+}
+
+const char* BenchmarkNames()
+{
+    return "channelizer, correlator";
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+class QString;
+
+// Offline throughput benchmarks of the DSP stages, no device needed.
+// Returns false for an unknown benchmark name.
+bool RunBenchmark(const QString& name);
+
+const char* BenchmarkNames();
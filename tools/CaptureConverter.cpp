@@ -0,0 +1,321 @@
+#include <QDir>
+#include <QHash>
+#include <QFile>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+#include "pipeline/WorkStealingThreadPool.hpp"
+#include "recording/RecordingIndex.hpp"
+#include "types/CaptureConversionConfig.hpp"
+#include "dsp/BlockStatistics.hpp"
+#include "tracing/Tracer.hpp"
+#include "CaptureConverter.hpp"
+
+inline const int BatchFiles = 256;
+inline const qint64 BatchBytes = 64 * 1024 * 1024;
+inline const char* CaptureFolderFormat = "dd.MM.yyyy_hh.mm.ss";
+
+struct CaptureBlock
+{
+    quint64 number = 0;
+    QString path;
+    qint64 size = 0;
+    qint64 timestamp = 0;
+};
+
+struct ConversionTotals
+{
+    int files = 0;
+    quint64 inputBytes = 0;
+    quint64 outputBytes = 0;
+};
+
+// Block files of a capture sorted by number, other files are skipped
+static QVector<CaptureBlock> CaptureBlocks(const QDir& dir)
+{
+    QVector<CaptureBlock> blocks;
+    for (const auto& info : dir.entryInfoList({ "*.bin" }, QDir::Files))
+    {
+        bool isNumber = false;
+        const quint64 number = info.completeBaseName().toULongLong(&isNumber);
+        if (not isNumber) continue;
+
+        CaptureBlock block;
+        block.number = number;
+        block.path = info.absoluteFilePath();
+        block.size = info.size();
+        block.timestamp = info.lastModified().toMSecsSinceEpoch();
+        blocks.append(block);
+    }
+
+    std::sort(blocks.begin(), blocks.end(),
+              [](const CaptureBlock& a, const CaptureBlock& b) { return a.number < b.number; });
+    return blocks;
+}
+
+static bool WriteAll(QFile& file, const QByteArray& data)
+{
+    if (file.write(data) == data.size()) return true;
+
+    qWarning("[CaptureConverter] '%s' write error: %s!", qPrintable(file.fileName()), qPrintable(file.errorString()));
+    return false;
+}
+
+// Converts one block file, entry keeps the source index metadata if any
+static bool ConvertBlock(const CaptureBlock& block, const CaptureConversionConfig& config,
+                         const RecordingIndexEntry* source, QByteArray& output, RecordingIndexEntry& entry)
+{
+    QFile file(block.path);
+    if (not file.open(QIODevice::ReadOnly))
+    {
+        qWarning("[CaptureConverter] '%s' open error: %s!", qPrintable(block.path), qPrintable(file.errorString()));
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+    const auto samples = reinterpret_cast<const qint16*>(data.constData());
+    const size_t count = data.size() / (sizeof(qint16) * 2);
+
+    if (source)
+    {
+        entry = *source;
+    }
+    else
+    {
+        BlockStatistics statistics;
+        AccumulateBlockStatistics(samples, count, statistics);
+
+        entry = RecordingIndexEntry();
+        entry.blockNumber = block.number;
+        entry.timestamp = block.timestamp;
+        entry.meanPower = statistics.meanPower() / FullScalePower;
+        entry.peakPower = statistics.peakPower / FullScalePower;
+        entry.clippedSamples = statistics.clippedSamples;
+    }
+
+    output = QByteArray(count * SampleFormatSize(config.format), Qt::Uninitialized);
+    ConvertFromI16(samples, count, config.format, output.data());
+
+    entry.flags &= ~IndexEntryCompressed;
+    if (config.compress)
+    {
+        output = qCompress(output);
+        entry.flags |= IndexEntryCompressed;
+    }
+
+    entry.size = output.size();
+    return true;
+}
+
+static bool ConvertCapture(const QDir& dir, const QVector<CaptureBlock>& blocks,
+                           const CaptureConversionConfig& config, ConversionTotals& totals)
+{
+    TRACE_SCOPE("CaptureConverter::convertCapture");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Without a source index the statistics are recomputed and the file times used
+    RecordingIndex sourceIndex;
+    QHash<quint64, int> sourceEntries;
+    const bool hasIndex = RecordingIndex::exists(dir.absolutePath()) and sourceIndex.load(dir.absolutePath());
+    if (hasIndex)
+    {
+        const auto& entries = sourceIndex.entries();
+        for (int i = 0; i < entries.count(); ++i) sourceEntries.insert(entries.at(i).blockNumber, i);
+    }
+
+    const auto folderTime = QDateTime::fromString(dir.dirName(), CaptureFolderFormat);
+    qint64 startTimestamp = folderTime.isValid() ? folderTime.toMSecsSinceEpoch() : blocks.first().timestamp;
+    if (hasIndex) startTimestamp = sourceIndex.header().startTimestamp;
+
+    QDir output(config.outputDirectory);
+    if (not output.mkpath(dir.dirName()) or not output.cd(dir.dirName()))
+    {
+        qWarning("[CaptureConverter] Output folder '%s' create error!", qPrintable(output.filePath(dir.dirName())));
+        return false;
+    }
+
+    QFile samplesFile(output.filePath(RecordingIndex::samplesFileName(config.format, config.compress)));
+    if (not samplesFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[CaptureConverter] '%s' open error: %s!",
+                 qPrintable(samplesFile.fileName()), qPrintable(samplesFile.errorString()));
+        QDir(config.outputDirectory).rmdir(dir.dirName());
+        return false;
+    }
+
+    if (not hasIndex and config.sampleRate == 0)
+    {
+        qWarning("[CaptureConverter] '%s' has no index, sample rate is unknown without --rate!",
+                 qPrintable(dir.dirName()));
+    }
+
+    RecordingIndexWriter index;
+
+    // A failed capture leaves no truncated samples file or index behind
+    const auto discard = [&]()
+    {
+        samplesFile.remove();
+        index.discard();
+        QDir(config.outputDirectory).rmdir(dir.dirName());
+        return false;
+    };
+
+    if (not index.open(output.absolutePath(),
+                       hasIndex ? sourceIndex.header().sampleRate : config.sampleRate,
+                       hasIndex ? sourceIndex.header().frequency : config.frequency,
+                       startTimestamp, config.format,
+                       IndexSamplesFile | (config.compress ? IndexCompressed : 0)))
+    {
+        return discard();
+    }
+
+    auto& pool = WorkStealingThreadPool::globalInstance();
+    QVector<QByteArray> converted;
+    QVector<RecordingIndexEntry> entries;
+    QVector<char> succeeded;
+    QByteArray pending;
+    bool written = true;
+    quint64 inputBytes = 0;
+
+    // Batch k is read and converted on the pool while one extra task writes
+    // batch k - 1 as a single sequential write. The write is chunk 0: chunks
+    // are taken in order, so it starts first and overlaps the conversion.
+    for (int first = 0; first < blocks.count();)
+    {
+        int last = first;
+        qint64 batchBytes = 0;
+        while (last < blocks.count() and last - first < BatchFiles and batchBytes < BatchBytes)
+        {
+            batchBytes += blocks.at(last++).size;
+        }
+
+        const int count = last - first;
+        converted.fill(QByteArray(), count);
+        entries.resize(count);
+        succeeded.fill(false, count);
+
+        // Raw pointers, the vectors must not detach inside the workers
+        const auto convertedData = converted.data();
+        const auto entriesData = entries.data();
+        const auto succeededData = succeeded.data();
+
+        pool.parallelFor(count + 1, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t chunk = begin; chunk < end; ++chunk)
+            {
+                if (chunk == 0)
+                {
+                    written = pending.isEmpty() or WriteAll(samplesFile, pending);
+                    continue;
+                }
+
+                const size_t i = chunk - 1;
+                const auto& block = blocks.at(first + i);
+                const int source = sourceEntries.value(block.number, -1);
+                succeededData[i] = ConvertBlock(block, config,
+                                                (source < 0) ? nullptr : &sourceIndex.entries().at(source),
+                                                convertedData[i], entriesData[i]);
+            }
+        });
+
+        if (not written) return discard();
+        if (std::find(succeeded.begin(), succeeded.end(), false) not_eq succeeded.end()) return discard();
+
+        qint64 pendingSize = 0;
+        for (const auto& data : qAsConst(converted)) pendingSize += data.size();
+
+        pending.clear();
+        pending.reserve(pendingSize);
+        for (int i = 0; i < count; ++i)
+        {
+            pending += converted.at(i);
+            if (not index.append(entries.at(i), false)) return discard();
+        }
+
+        inputBytes += batchBytes;
+        first = last;
+    }
+
+    if (not pending.isEmpty() and not WriteAll(samplesFile, pending)) return discard();
+    samplesFile.close();
+
+    if (not index.finish()) return discard();
+
+    const double seconds = qMax(timer.nsecsElapsed() / 1e9, 1e-9);
+    const quint64 outputBytes = index.recordedBytes();
+
+    qInfo("[CaptureConverter] '%s': %i files | %.1f MB -> %.1f MB | %.2f s | %.1f MB/s | %.0f files/s",
+          qPrintable(dir.dirName()), blocks.count(), inputBytes / 1e6, outputBytes / 1e6,
+          seconds, inputBytes / 1e6 / seconds, blocks.count() / seconds);
+
+    totals.files += blocks.count();
+    totals.inputBytes += inputBytes;
+    totals.outputBytes += outputBytes;
+    return true;
+}
+
+bool RunCaptureConversion(const CaptureConversionConfig& config)
+{
+    QDir source(config.source);
+    if (not source.exists())
+    {
+        qWarning("[CaptureConverter] Folder '%s' does not exist!", qPrintable(config.source));
+        return false;
+    }
+
+    // Either a capture folder itself or a folder of captures (RX)
+    QVector<QDir> captures;
+    if (CaptureBlocks(source).isEmpty())
+    {
+        for (const auto& name : source.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+        {
+            captures.append(QDir(source.filePath(name)));
+        }
+    }
+    else captures.append(source);
+
+    qInfo("[CaptureConverter] %i captures -> '%s' as %s%s, %u threads.",
+          captures.count(), qPrintable(config.outputDirectory), SampleFormatName(config.format),
+          config.compress ? " compressed" : "", WorkStealingThreadPool::globalInstance().threadsCount());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    ConversionTotals totals;
+    int converted = 0;
+    int failed = 0;
+    for (const auto& capture : qAsConst(captures))
+    {
+        // Converted folders have no block files, so they are never picked up here
+        const auto blocks = CaptureBlocks(capture);
+        if (blocks.isEmpty()) continue;
+
+        if (not ConvertCapture(capture, blocks, config, totals))
+        {
+            qWarning("[CaptureConverter] Capture '%s' conversion failed!", qPrintable(capture.dirName()));
+            ++failed;
+            continue;
+        }
+
+        ++converted;
+    }
+
+    const double seconds = qMax(timer.nsecsElapsed() / 1e9, 1e-9);
+    qInfo("[CaptureConverter] Total: %i captures | %i failed | %i files | %.1f MB -> %.1f MB | %.2f s | "
+          "%.1f MB/s | %.0f files/s",
+          converted, failed, totals.files, totals.inputBytes / 1e6, totals.outputBytes / 1e6,
+          seconds, totals.inputBytes / 1e6 / seconds, totals.files / seconds);
+
+    if (converted + failed == 0)
+    {
+        qWarning("[CaptureConverter] No captures found in '%s'!", qPrintable(config.source));
+        return false;
+    }
+
+    return failed == 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+struct CaptureConversionConfig;
+
+// Merges "<block number>.bin" files of RX capture folders into one samples
+// file per capture with an index, reading and converting on all cores.
+// False if a capture failed (its outputs are removed) or none was found.
+bool RunCaptureConversion(const CaptureConversionConfig& config);
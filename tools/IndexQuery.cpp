@@ -0,0 +1,98 @@
+#include "recording/RecordingIndex.hpp"
+#include "types/IndexQueryConfig.hpp"
+#include "dsp/BlockStatistics.hpp"
+#include "IndexQuery.hpp"
+
+static QString ExtractPath(const QString& path, int number, int count)
+{
+    if (count == 1) return path;
+
+    const int dot = path.lastIndexOf('.');
+    const QString suffix = "_" + QString::number(number);
+    return (dot > path.lastIndexOf('/')) ? path.left(dot) + suffix + path.mid(dot) : path + suffix;
+}
+
+bool RunIndexQuery(const IndexQueryConfig& config)
+{
+    RecordingIndex index;
+    if (not index.load(config.directory)) return false;
+
+    const auto& entries = index.entries();
+    const auto& header = index.header();
+    if (entries.isEmpty())
+    {
+        qInfo("[IndexQuery] Recording is empty.");
+        return true;
+    }
+
+    const qint64 fromMs = config.fromSeconds * 1000;
+    const qint64 toMs = (config.toSeconds < 0) ? entries.last().timestamp - header.startTimestamp
+                                               : qint64(config.toSeconds * 1000);
+    const auto timeRange = index.findTimeRange(fromMs, toMs);
+
+    QVector<RecordingRange> ranges;
+    if (config.energeticOnly)
+    {
+        for (auto range : index.findEnergetic(config.thresholdDbfs))
+        {
+            range.first = qMax(range.first, timeRange.first);
+            range.last = qMin(range.last, timeRange.last);
+            if (not range.isEmpty()) ranges.append(range);
+        }
+    }
+    else if (not timeRange.isEmpty()) ranges.append(timeRange);
+
+    qInfo("[IndexQuery] %i blocks, %i pyramid levels, %llu Hz @ %llu Hz, %i ranges found.",
+          entries.count(), index.levelsCount(), header.sampleRate, header.frequency, ranges.count());
+
+    if (header.flags & IndexSamplesFile)
+    {
+        qInfo("[IndexQuery] Converted capture, samples in '%s'.",
+              qPrintable(RecordingIndex::samplesFileName(static_cast<SampleFormat>(header.sampleFormat),
+                                                         header.flags & IndexCompressed)));
+    }
+
+    for (int i = 0; i < ranges.count(); ++i)
+    {
+        const auto& range = ranges.at(i);
+        const auto& first = entries.at(range.first);
+        const auto& last = entries.at(range.last - 1);
+        const auto summary = index.summary(range);
+
+        int gaps = 0;
+        quint64 clipped = first.clippedSamples;
+        float minimumGain = first.gain;
+        float maximumGain = first.gain;
+        for (int j = range.first + 1; j < range.last; ++j)
+        {
+            const auto& entry = entries.at(j);
+            if (entry.flags & IndexEntryDiscontinuity) ++gaps;
+
+            clipped += entry.clippedSamples;
+            minimumGain = qMin(minimumGain, entry.gain);
+            maximumGain = qMax(maximumGain, entry.gain);
+        }
+
+        qInfo("[IndexQuery] #%i: %.3f - %.3f s | blocks %llu - %llu | bytes %llu + %llu | "
+              "mean %.1f dBFS | peak %.1f dBFS | gaps %i | gain %.0f - %.0f dB | clipped %llu",
+              i,
+              (first.timestamp - header.startTimestamp) / 1000.0,
+              (last.timestamp - header.startTimestamp) / 1000.0,
+              first.blockNumber, last.blockNumber,
+              first.offset, last.offset + last.size - first.offset,
+              PowerToDbfs(summary.meanPower * FullScalePower),
+              PowerToDbfs(summary.peakPower * FullScalePower),
+              gaps,
+              minimumGain, maximumGain,
+              clipped);
+
+        if (config.extractPath.isEmpty()) continue;
+
+        const auto path = ExtractPath(config.extractPath, i, ranges.count());
+        if (not index.extract(range, path)) return false;
+
+        qInfo("[IndexQuery] #%i extracted to '%s'.", i, qPrintable(path));
+    }
+
+    return true;
+}
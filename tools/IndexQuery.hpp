@@ -0,0 +1,7 @@
+#pragma once
+
+struct IndexQueryConfig;
+
+// Prints block ranges of a capture folder matching the query and
+// optionally extracts them into contiguous files
+bool RunIndexQuery(const IndexQueryConfig& config);
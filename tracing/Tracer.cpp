@@ -0,0 +1,253 @@
+#include <QFile>
+
+#include <chrono>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "Tracer.hpp"
+
+inline const size_t MaxBufferedEvents = 64 * 1024;
+inline const int FlushIntervalMs = 200;
+inline const int WriteChunkBytes = 1024 * 1024;
+
+// Names are plain C strings, interned ones may hold anything
+static QByteArray JsonString(const char* text)
+{
+    QByteArray result;
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' or *c == '\\')
+        {
+            result += '\\';
+            result += *c;
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20)
+        {
+            result += "\\u00";
+            result += QByteArray::number(static_cast<unsigned char>(*c), 16).rightJustified(2, '0');
+        }
+        else result += *c;
+    }
+
+    return result;
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer()
+{
+    stop();
+}
+
+bool Tracer::start(const QString& fileName)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEnabled.load()) return false;
+
+    for (auto buffer : mBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+
+    mOutput.setFileName(fileName);
+    if (not mOutput.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("[Tracer] Trace file open error: %s!", qPrintable(mOutput.errorString()));
+        return false;
+    }
+
+    mOutput.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    mFirstEvent = true;
+    mWriteError = false;
+    mWritten = 0;
+    mDropped.store(0);
+    mWriterStop = false;
+
+    now();
+    mEnabled.store(true);
+    mWriter = std::thread(&Tracer::writerRoutine, this);
+    return true;
+}
+
+bool Tracer::stop()
+{
+    if (not mEnabled.exchange(false)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mWriterMutex);
+        mWriterStop = true;
+    }
+    mWriterWakeUp.notify_one();
+    mWriter.join();
+
+    // The writer has flushed everything, thread names close the array
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto pid = getpid();
+    QByteArray json;
+    for (auto buffer : mBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (not buffer->threadName) continue;
+
+        appendEvent(json, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + QByteArray::number(pid)
+                          + ",\"tid\":" + QByteArray::number(buffer->threadId)
+                          + ",\"args\":{\"name\":\"" + JsonString(buffer->threadName) + "\"}}");
+    }
+
+    json += "\n]}\n";
+
+    if (mWriteError or mOutput.write(json) not_eq json.size() or not mOutput.flush())
+    {
+        qWarning("[Tracer] Trace file write error: %s!", qPrintable(mOutput.errorString()));
+        mOutput.close();
+        return false;
+    }
+    mOutput.close();
+
+    if (mDropped.load() > 0)
+    {
+        qWarning("[Tracer] %llu spans dropped, trace buffers were full!", mDropped.load());
+    }
+
+    qInfo("[Tracer] %llu spans saved to '%s'.", mWritten, qPrintable(mOutput.fileName()));
+    return true;
+}
+
+void Tracer::record(const char* name, const char* category, qint64 beginNs, qint64 endNs)
+{
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    if (buffer.events.size() >= MaxBufferedEvents)
+    {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events.push_back({ name, category, beginNs, endNs });
+}
+
+void Tracer::writerRoutine()
+{
+    setThreadName("trace writer");
+
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    while (true)
+    {
+        const bool stop = mWriterWakeUp.wait_for(lock, std::chrono::milliseconds(FlushIntervalMs),
+                                                 [this]() { return mWriterStop; });
+        lock.unlock();
+        if (not writeEvents()) mWriteError = true;
+        lock.lock();
+
+        if (stop) return;
+    }
+}
+
+bool Tracer::writeEvents()
+{
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        buffers = mBuffers;
+    }
+
+    const auto pid = getpid();
+    std::vector<Event> events;
+    QByteArray json;
+    bool result = true;
+
+    for (auto buffer : buffers)
+    {
+        // Swap out under the lock, format without it
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            events.swap(buffer->events);
+        }
+
+        for (const auto& event : events)
+        {
+            appendEvent(json, "{\"name\":\"" + JsonString(event.name)
+                              + "\",\"cat\":\"" + JsonString(event.category)
+                              + "\",\"ph\":\"X\",\"ts\":" + QByteArray::number(event.beginNs / 1000.0, 'f', 3)
+                              + ",\"dur\":" + QByteArray::number((event.endNs - event.beginNs) / 1000.0, 'f', 3)
+                              + ",\"pid\":" + QByteArray::number(pid)
+                              + ",\"tid\":" + QByteArray::number(buffer->threadId) + "}");
+
+            if (json.size() >= WriteChunkBytes)
+            {
+                result = result and mOutput.write(json) == json.size();
+                json.clear();
+            }
+        }
+
+        mWritten += events.size();
+        events.clear();
+    }
+
+    return result and mOutput.write(json) == json.size();
+}
+
+void Tracer::appendEvent(QByteArray& json, const QByteArray& event)
+{
+    if (not mFirstEvent) json += ",\n";
+    mFirstEvent = false;
+    json += event;
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+const char* Tracer::intern(const QString& name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mInterned.insert(name.toStdString()).first->c_str();
+}
+
+qint64 Tracer::now()
+{
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - origin).count();
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer()
+{
+    // Buffers are never freed: spans of finished threads stay in the trace
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (not buffer)
+    {
+        buffer = new ThreadBuffer;
+        buffer->threadId = syscall(SYS_gettid);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBuffers.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category)
+    : mName(name)
+    , mCategory(category)
+{
+    if (Tracer::instance().enabled()) mBeginNs = Tracer::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (mBeginNs and Tracer::instance().enabled())
+    {
+        Tracer::instance().record(mName, mCategory, mBeginNs, Tracer::now());
+    }
+}
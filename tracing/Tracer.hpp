@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+// Scoped spans exported as Chrome trace-event JSON (chrome://tracing,
+// Perfetto). While disabled a span costs the initialization guard check
+// of the instance() static and one relaxed atomic load.
+// Span names must outlive the tracer: literals or intern()'ed strings.
+// A writer thread streams the per-thread buffers into the file several
+// times a second. Buffers are capped, spans beyond the cap are dropped
+// and counted, so a long mission does not grow memory.
+
+class Tracer
+{
+public:
+    static Tracer& instance();
+    ~Tracer();
+
+    bool start(const QString& fileName);
+    // Completes the trace file, spans recorded after this are dropped
+    bool stop();
+
+    bool enabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+    void record(const char* name, const char* category, qint64 beginNs, qint64 endNs);
+    void setThreadName(const char* name);
+    const char* intern(const QString& name);
+
+    static qint64 now();
+
+private:
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        qint64 beginNs;
+        qint64 endNs;
+    };
+
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<Event> events;
+        const char* threadName = nullptr;
+        quint64 threadId = 0;
+    };
+
+    Tracer() = default;
+    ThreadBuffer& threadBuffer();
+    void writerRoutine();
+    bool writeEvents();
+    void appendEvent(QByteArray& json, const QByteArray& event);
+
+private:
+    std::atomic_bool mEnabled = false;
+    std::atomic<quint64> mDropped = 0;
+
+    std::mutex mMutex;
+    std::vector<ThreadBuffer*> mBuffers;
+    std::set<std::string> mInterned;
+
+    // Touched by the writer thread only while it runs
+    QFile mOutput;
+    bool mFirstEvent = true;
+    bool mWriteError = false;
+    quint64 mWritten = 0;
+
+    std::thread mWriter;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterWakeUp;
+    bool mWriterStop = false;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name, const char* category = "app");
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* mName;
+    const char* mCategory;
+    qint64 mBeginNs = 0;
+};
+
+#define TRACE_JOIN_IMPL(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN_IMPL(a, b)
+
+#define TRACE_SCOPE(name) TraceSpan TRACE_JOIN(traceSpan, __LINE__)(name)
+
+// Traces a single call: if (TRACE_CALL(LMS_Init, mDevice) not_eq 0)
+#define TRACE_CALL(function, ...) \
+    ([&]() { TraceSpan span(#function, "lms"); return function(__VA_ARGS__); }())
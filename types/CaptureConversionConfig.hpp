@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QString>
+
+#include "dsp/SampleConversion.hpp"
+
+struct CaptureConversionConfig
+{
+    QString source;             // capture folder or folder of captures (RX)
+    QString outputDirectory;
+    SampleFormat format = SampleFormat::I16;
+    bool compress = false;
+    quint64 sampleRate = 0;     // for captures without index.bin
+    quint64 frequency = 0;
+};
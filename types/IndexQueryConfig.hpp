@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QString>
+
+struct IndexQueryConfig
+{
+    QString directory;
+    double fromSeconds = 0;
+    double toSeconds = -1;      // negative = till the end
+    bool energeticOnly = false;
+    double thresholdDbfs = 0;
+    QString extractPath;        // empty = only print ranges
+};
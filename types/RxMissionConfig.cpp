@@ -16,6 +16,11 @@ const char* RxMissionConfig::argsExample()
 bool RxMissionConfig::valid() const
 {
     return samplesCount not_eq 0
+       and (sharedMemoryName.isEmpty() or sharedMemorySlots not_eq 0)
+       and ringSeconds >= 0
+       and (channelsCount == 0 or (channelsCount > 1 and (channelsCount & (channelsCount - 1)) == 0))
+       and preambleThreshold > 0 and preambleThreshold <= 1
+       and (not agc or agcTargetDbfs < 0)
        and AbstractMissionConfig::valid();
 }
 
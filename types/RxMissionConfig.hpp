@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QString>
+
 #include "AbstractMissionConfig.hpp"
 
 struct RxMissionConfig : public AbstractMissionConfig
@@ -12,4 +14,18 @@ struct RxMissionConfig : public AbstractMissionConfig
 
 public:
     unsigned samplesCount = 0;
+
+    QString sharedMemoryName;
+    unsigned sharedMemorySlots = 64;
+
+    bool iqCorrection = false;
+    unsigned channelsCount = 0;
+    double ringSeconds = 0;
+
+    QString preambleFileName;
+    double preambleThreshold = 0.5;
+    unsigned preambleWindow = 0;
+
+    bool agc = false;
+    double agcTargetDbfs = -20;
 };
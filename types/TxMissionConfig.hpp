@@ -2,6 +2,7 @@
 
 #include <QString>
 
+#include "dsp/SampleConversion.hpp"
 #include "AbstractMissionConfig.hpp"
 
 struct TxMissionConfig : public AbstractMissionConfig
@@ -14,5 +15,8 @@ struct TxMissionConfig : public AbstractMissionConfig
 
 public:
     QString fileName;
+    SampleFormat fileFormat = SampleFormat::I16;
+    unsigned long long fileSampleRate = 0; // 0 - mission sample rate
+    double digitalGainDb = 0;
 
 };